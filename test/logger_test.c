@@ -3,5 +3,25 @@ int main()
 {
     VWARN("logged.txt", "YOUR TEST%d", 1);
     VINFO("logged.txt", "YOUR TEST%d", 2);
+
+    vloggerStart(VLOG_MODE_ASYNC, 0);
+    for (int i = 0; i < 100; i++) {
+        VINFO("logged.txt", "ASYNC TEST%d", i);
+    }
+    vloggerFlush();
+    VERROR(NULL, "ASYNC TEST%d", 100);
+    vloggerShutdown();
+
+    vloggerStart(VLOG_MODE_PER_THREAD, 0);
+    for (int i = 0; i < 100; i++) {
+        VINFO("logged.txt", "PER THREAD TEST%d", i);
+    }
+    vloggerShutdown();
+
+    vloggerMapStream("mapped.txt", 0);
+    for (int i = 0; i < 100; i++) {
+        VINFO("mapped.txt", "MAPPED TEST%d", i);
+    }
+    vloggerShutdown();
     return 0;
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 
 #include <vvec.h>
+#include <vpool.h>
+#include <vslotmap.h>
+#include <vmem.h>
+#include <varena.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stringex.h>
 #include <vtypes.h>
 
+VVEC_DEFINE(vvec_int, int)
+
 int str_ctor(void * self, size_t size, va_list args, size_t count)
 {   
     char* arg = va_arg(args, char*);
@@ -32,6 +38,127 @@ void str_dtor(void * self, size_t size)
     *str_ptr = NULL;
 }
 
+// Copy constructor that fails once `str_copies_left` runs out
+int str_copies_left = 0;
+int str_cctor_limited(void * self, const void * original, size_t size)
+{
+    if (str_copies_left-- <= 0) return -1;
+    return str_cctor(self, original, size);
+}
+
+void square_fn(void* out, const void* in, size_t index, void* ctx)
+{
+    *(int*)out = *(const int*)in * *(const int*)in;
+}
+
+void sum_fn(void* acc, const void* item, size_t index, void* ctx)
+{
+    *(long long*)acc += *(const int*)item;
+}
+
+void sum_combine(void* acc, const void* other, void* ctx)
+{
+    *(long long*)acc += *(const long long*)other;
+}
+
+int int_cmp(const void* a, const void* b)
+{
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int is_odd(const void* item, void* ctx)
+{
+    return *(const int*)item & 1;
+}
+
+int ll_cmp(const void* a, const void* b)
+{
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct pair_t { long long key; long long tag; } pair_t;
+
+int pair_cmp(const void* a, const void* b)
+{
+    return ll_cmp(&((const pair_t*)a)->key, &((const pair_t*)b)->key);
+}
+
+typedef struct keyed_t { int32_t i; float f; uint32_t order; } keyed_t;
+
+/*
+    McIlroy's quicksort adversary: items are indices whose values are only
+    fixed ("frozen") when a comparison needs them, chosen so every pivot is bad.
+    Any plain quicksort goes quadratic, introsort has to fall back to heapsort.
+*/
+int adv_val[4096], adv_gas, adv_solid, adv_candidate;
+size_t adv_compares;
+
+int adv_cmp(const void* a, const void* b)
+{
+    int x = *(const int*)a, y = *(const int*)b;
+    adv_compares++;
+    if (adv_val[x] == adv_gas && adv_val[y] == adv_gas) {
+        adv_val[(x == adv_candidate)? x : y] = adv_solid++;
+    }
+    if (adv_val[x] == adv_gas) adv_candidate = x;
+    else if (adv_val[y] == adv_gas) adv_candidate = y;
+    return adv_val[x] - adv_val[y];
+}
+
+// Sorts `count` values below `range` with vvec_sort and compares against qsort, returns 1 if they match
+int check_sort(size_t stride, size_t count, int range, vvec_cmp_fn cmp)
+{
+    vvec_t* v = _vvec_create(stride, count, 0.5);
+    char* expected = malloc(count * stride);
+    for (size_t i = 0; i < count; i++) {
+        char item[sizeof(pair_t)] = {0};
+        long long value = rand() % range;
+        memcpy(item, &value, (stride < sizeof(value))? stride : sizeof(value));
+        if (stride == sizeof(pair_t)) ((pair_t*)item)->tag = (long long)i;
+        vvec_push_back(v, item);
+        memcpy(expected + i * stride, item, stride);
+    }
+    vvec_sort(v, cmp);
+    qsort(expected, count, stride, cmp);
+
+    int ok = 1;
+    for (size_t i = 0; i < count; i++) {
+        ok &= cmp(vvec_at(v, i), expected + i * stride) == 0;
+    }
+    free(expected);
+    vvec_destroy(&v);
+    return ok;
+}
+
+// 1 if the element storage of `v` starts on an `align` byte boundary
+int is_aligned(vvec_t* v, size_t align)
+{
+    return ((uintptr_t)vvec_at(v, 0) % align) == 0;
+}
+
+// Allocator that counts live bytes and forwards to the heap allocator
+void* counting_alloc(void* ctx, size_t size, size_t align)
+{
+    void* ptr = vallocator_heap()->alloc(NULL, size, align);
+    if (ptr) *(size_t*)ctx += size;
+    return ptr;
+}
+
+void* counting_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align)
+{
+    void* new_ptr = vallocator_heap()->realloc(NULL, ptr, old_size, new_size, align);
+    if (new_ptr) *(size_t*)ctx += new_size - old_size;
+    return new_ptr;
+}
+
+void counting_free(void* ctx, void* ptr, size_t size)
+{
+    vallocator_heap()->free(NULL, ptr, size);
+    *(size_t*)ctx -= size;
+}
+
 int main() 
 {   
     vvec1_t* v = vvec1_create(int, 2, 0.75, NULL, NULL, NULL);
@@ -113,6 +240,193 @@ int main()
 
     vvec_destroy(&v0);
     printf("is_empty = %d \n", vvec_empty(v0));
+
+    vvec1_t* words = vvec1_create(vcp, 0, 0, str_ctor, str_cctor_limited, str_dtor);
+    vcp word = "word";
+    str_copies_left = 5;
+    for (int i = 0; i < 5; i++) {
+        vvec_emplace_back(words, 1, word);
+    }
+    int fill_ret = vvec_fill(words, vvec_at(words, 4)); // the value and four items are copied, the fifth copy fails
+    printf("failed fill ret = %d size = %llu\n", fill_ret, vvec_get_field(words, VVEC_FIELD_LENGTH));
+    vvec_destroy(&words);
+
+    vvec_t* small = vvec_create_inline(int, 8, 0.5);
+    for (int i = 0; i < 20; i++) {
+        vvec_push_back(small, &i);
+        printf("inline size = %llu capacity = %llu\n", vvec_get_field(small, VVEC_FIELD_LENGTH), vvec_get_field(small, VVEC_FIELD_CAPACITY));
+    }
+    int batch[4] = {100, 101, 102, 103};
+    vvec_append_n(small, batch, 4);
+    vvec_insert_range(small, 0, batch, 2);
+    printf("after batch size = %llu front = %d back = %d\n", vvec_get_field(small, VVEC_FIELD_LENGTH), *(int*)vvec_front(small), *(int*)vvec_back(small));
+    vvec_swap_remove(small, 0);
+    printf("removed %llu odd items, size = %llu\n", (unsigned long long)vvec_remove_if(small, is_odd, NULL), vvec_get_field(small, VVEC_FIELD_LENGTH));
+    vvec_sort(small, int_cmp);
+    int needle = 19;
+    printf("sorted front = %d back = %d index of 19 = %lld\n", *(int*)vvec_front(small), *(int*)vvec_back(small), (long long)vvec_binary_search(small, &needle, int_cmp));
+    vvec_destroy(&small);
+
+    vvec_t* wide = vvec_create_aligned(int, 3, 0.5, 64);
+    int first = 0;
+    vvec_push_back(wide, &first);
+    int aligned_ok = is_aligned(wide, 64);
+    for (int i = 1; i < 1000; i++) {
+        vvec_push_back(wide, &i);
+        aligned_ok &= is_aligned(wide, 64);
+    }
+    vvec_erase(wide, 10, 1000);
+    vvec_shrink_to_fit(wide);
+    aligned_ok &= is_aligned(wide, 64);
+    vvec_set_field(wide, VVEC_FIELD_ALIGNMENT, 128);
+    aligned_ok &= is_aligned(wide, 128) && *(int*)vvec_at(wide, 9) == 9;
+    vvec_destroy(&wide);
+
+    vvec_t* packed = vvec_create_inline(int, 4, 0.5);
+    for (int i = 0; i < 3; i++) {
+        vvec_push_back(packed, &i);
+    }
+    vvec_set_field(packed, VVEC_FIELD_ALIGNMENT, 256);
+    aligned_ok &= is_aligned(packed, 256) && *(int*)vvec_at(packed, 2) == 2;
+    for (int i = 3; i < 100; i++) {
+        vvec_push_back(packed, &i);
+        aligned_ok &= is_aligned(packed, 256);
+    }
+    vvec_shrink_to_fit(packed);
+    aligned_ok &= is_aligned(packed, 256) && *(int*)vvec_at(packed, 99) == 99;
+    printf("aligned storage ok = %d\n", aligned_ok);
+    vvec_destroy(&packed);
+    if (!aligned_ok) return 1;
+
+    srand(1);
+    int sort_ok = check_sort(sizeof(int), 5000, 1 << 30, int_cmp)
+               && check_sort(sizeof(int), 5000, 8, int_cmp)
+               && check_sort(sizeof(long long), 3000, 1 << 30, ll_cmp)
+               && check_sort(sizeof(long long), 3000, 3, ll_cmp)
+               && check_sort(sizeof(pair_t), 3000, 1000, pair_cmp)
+               && check_sort(sizeof(pair_t), 3000, 2, pair_cmp);
+
+    vvec_t* adversary = vvec_create(int, 2000, 0.5);
+    adv_gas = 2000;
+    adv_solid = 0;
+    adv_candidate = 0;
+    adv_compares = 0;
+    for (int i = 0; i < 2000; i++) {
+        adv_val[i] = adv_gas;
+        vvec_push_back(adversary, &i);
+    }
+    vvec_sort(adversary, adv_cmp);
+    for (int i = 1; i < 2000; i++) {
+        sort_ok &= adv_val[*(int*)vvec_at(adversary, i - 1)] <= adv_val[*(int*)vvec_at(adversary, i)];
+    }
+    sort_ok &= adv_compares < 200000; // Quadratic would be millions
+    vvec_destroy(&adversary);
+
+    vvec_t* keyed = vvec_create(keyed_t, 4000, 0.5);
+    for (int i = 0; i < 4000; i++) {
+        keyed_t k = { rand() % 2001 - 1000, (float)(rand() % 2001 - 1000) / 8.0f, (uint32_t)i };
+        vvec_push_back(keyed, &k);
+    }
+    vvec_sort_by_key(keyed, VVEC_KEY_I32, offsetof(keyed_t, i));
+    for (size_t i = 1; i < 4000; i++) {
+        keyed_t* a = vvec_at(keyed, i - 1);
+        keyed_t* b = vvec_at(keyed, i);
+        sort_ok &= a->i < b->i || (a->i == b->i && a->order < b->order);
+    }
+    for (size_t i = 0; i < 4000; i++) {
+        ((keyed_t*)vvec_at(keyed, i))->order = (uint32_t)i;
+    }
+    vvec_sort_by_key(keyed, VVEC_KEY_F32, offsetof(keyed_t, f));
+    for (size_t i = 1; i < 4000; i++) {
+        keyed_t* a = vvec_at(keyed, i - 1);
+        keyed_t* b = vvec_at(keyed, i);
+        sort_ok &= a->f < b->f || (a->f == b->f && a->order < b->order);
+    }
+    vvec_destroy(&keyed);
+
+    vvec_t* evens = vvec_create(int, 100, 0.5);
+    for (int i = 0; i < 100; i++) {
+        int even = i * 2;
+        vvec_push_back(evens, &even);
+    }
+    int missing = 7, below = -1, above = 1000;
+    sort_ok &= vvec_lower_bound(evens, &missing, int_cmp) == 4
+            && vvec_lower_bound(evens, &below, int_cmp) == 0
+            && vvec_lower_bound(evens, &above, int_cmp) == 100
+            && vvec_binary_search(evens, &missing, int_cmp) == -1;
+    vvec_destroy(&evens);
+    printf("sort checks ok = %d\n", sort_ok);
+    if (!sort_ok) return 1;
+
+    vvec_int typed = {0};
+    for (int i = 0; i < 10; i++) {
+        vvec_int_push(&typed, i * i);
+    }
+    printf("typed size = %llu last = %d\n", (unsigned long long)vvec_int_size(&typed), *vvec_int_at(&typed, 9));
+    vvec_int_free(&typed);
+
+    vvec_t* nums = vvec_create(int, 1000, 0.5);
+    for (int i = 0; i < 1000; i++) {
+        vvec_push_back(nums, &i);
+    }
+    long long total = 0, zero = 0;
+    vvec_parallel_transform(nums, nums, square_fn, NULL, 0);
+    vvec_parallel_reduce(nums, &total, sizeof(total), &zero, sum_fn, sum_combine, NULL, 0);
+    printf("parallel sum of squares = %lld workers = %llu\n", total, (unsigned long long)vpool_get_workers(vpool_default()));
+
+    int key = 81;
+    printf("find 81 = %lld count 81 = %llu\n", (long long)vvec_find(nums, &key), (unsigned long long)vvec_count(nums, &key));
+    vvec_fill(nums, &key);
+    printf("after fill count 81 = %llu\n", (unsigned long long)vvec_count(nums, &key));
+    vvec_destroy(&nums);
+
+    vslotmap_t* entities = vslotmap_create(int, 4, NULL, NULL, NULL);
+    vslot_handle_t handles[4];
+    for (int i = 0; i < 4; i++) {
+        int hp = 100 + i;
+        handles[i] = vslotmap_insert(entities, &hp);
+    }
+    vslotmap_remove(entities, handles[1]);
+    printf("slotmap size = %llu stale = %d hp[3] = %d\n", (unsigned long long)vslotmap_size(entities),
+        vslotmap_get(entities, handles[1]) == NULL, *(int*)vslotmap_get(entities, handles[3]));
+    vslotmap_destroy(&entities);
+
+    size_t counted = 0;
+    vallocator_t counting = { counting_alloc, counting_realloc, counting_free, &counted };
+    vvec_t* scratch = vvec_create_alloc(int, 4, 0.5, &counting);
+    for (int i = 0; i < 100; i++) {
+        vvec_push_back(scratch, &i);
+    }
+    printf("counting allocator live bytes = %llu", (unsigned long long)counted);
+    vvec_destroy(&scratch);
+    printf(" after destroy = %llu\n", (unsigned long long)counted);
+
+    vvec_int counted_ints;
+    vvec_int_init_alloc(&counted_ints, &counting);
+    vslotmap_t* counted_map = vslotmap_create_alloc(int, 4, &counting, NULL, NULL, NULL);
+    varena_t* counted_arena = varena_create_alloc(1024, 1, &counting);
+    for (int i = 0; i < 100; i++) {
+        vvec_int_push(&counted_ints, i);
+        vslotmap_insert(counted_map, &i);
+        varena_alloc(counted_arena, 64, 0);
+    }
+    printf("typed, slotmap and arena live bytes = %llu", (unsigned long long)counted);
+    vvec_int_free(&counted_ints);
+    vslotmap_destroy(&counted_map);
+    varena_destroy(&counted_arena);
+    printf(" after destroy = %llu\n", (unsigned long long)counted);
+
+    varena_t* frame = varena_create(4096, 1);
+    vvec_t* temp = vvec_create_alloc(int, 16, 0.5, varena_allocator(frame));
+    for (int i = 0; i < 1000; i++) {
+        vvec_push_back(temp, &i);
+    }
+    printf("arena used = %llu label = %s\n", (unsigned long long)varena_used(frame), varena_strdup(frame, "frame 0"));
+    vvec_destroy(&temp);
+    varena_reset(frame);
+    varena_destroy(&frame);
+
+    vstd_mem_report();
     return 0;
     return 0;
 }
\ No newline at end of file
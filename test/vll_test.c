@@ -49,6 +49,78 @@ int main()
     vll_foreach(size_t, item, i,ll, printf("%llu\n", *item););
     vll_resize(ll, 2);
     vll_foreach(size_t, item, i,ll, printf("%llu\n", *item););
+
+    // link pool: past VLL_FIELD_POOL_THRESHOLD popped links are reused by the next push
+    for (size_t n = 0; n < 1000; n++)
+    {
+        vll_push_back(ll, &n);
+        if (n >= 100) vll_pop_at(ll, VLL_FRONT);
+    }
+    printf("pool threshold = %llu len = %llu front = %llu\n", vll_get_field(ll, VLL_FIELD_POOL_THRESHOLD),
+        vll_get_field(ll, VLL_FIELD_LENGTH), *(size_t*)vll_at(ll, VLL_FRONT));
+
+    // skip index: vll_at starts from the nearest checkpoint (every VLL_FIELD_SKIP_STEP positions)
+    t = 7;
+    vll_insert(ll, 50, &t);
+    printf("skip step = %llu [50] = %llu [75] = %llu\n", vll_get_field(ll, VLL_FIELD_SKIP_STEP),
+        *(size_t*)vll_at(ll, 50), *(size_t*)vll_at(ll, 75));
     vll_destroy(&ll);
+
+    // unrolled list: same API, 8 elements per link
+    vll_t* ull = vll_create_unrolled(size_t, 8);
+    for (size_t n = 0; n < 20; n++)
+    {
+        vll_push_back(ull, &n);
+    }
+    t = 100;
+    vll_insert(ull, 3, &t);
+    vll_erase(ull, 10, 15);
+    vll_pop_at(ull, 0);
+    printf("unrolled len = %llu [2] = %llu [9] = %llu\n", vll_get_field(ull, VLL_FIELD_LENGTH),
+        *(size_t*)vll_at(ull, 2), *(size_t*)vll_at(ull, 9));
+
+    // iterator: insert and erase in one pass without index lookups
+    for (vll_iter_t it = vll_begin(ull); vll_iter_valid(&it); )
+    {
+        size_t v = *(size_t*)vll_iter_get(&it);
+        if (v % 2) {
+            vll_erase_at(&it);
+            continue;
+        }
+        t = v + 1000;
+        vll_insert_after(&it, &t);
+        vll_iter_next(&it);
+        vll_iter_next(&it);
+    }
+    vll_foreach(size_t, item, i, ull, printf("%llu ", *item););
+    printf("\n");
+    vll_destroy(&ull);
+
+    // intrusive list: links nodes embedded in existing objects, no allocation or copy
+    struct widget { size_t id; vlist_node node; } widgets[4];
+    vlist_t scene = VLIST_INIT;
+    for (size_t n = 0; n < 4; n++)
+    {
+        widgets[n].id = n;
+        widgets[n].node = (vlist_node)VLIST_NODE_INIT;
+        vlist_push_front(&scene, &widgets[n].node);
+    }
+    vlist_unlink(&scene, &widgets[2].node);
+    vlist_foreach(struct widget, w, node, &scene, printf("%llu ", w->id););
+    printf("size = %llu\n", scene.size);
+
+#ifdef NDEBUG
+    // unlinking the tail of another list is rejected (debug builds assert instead)
+    struct widget other[2] = { { 8 }, { 9 } };
+    vlist_t hud = VLIST_INIT;
+    for (size_t n = 0; n < 2; n++)
+    {
+        other[n].node = (vlist_node)VLIST_NODE_INIT;
+        vlist_push_back(&hud, &other[n].node);
+    }
+    int bad = vlist_unlink(&scene, &other[1].node);
+    printf("foreign unlink = %d size = %llu hud size = %llu\n", bad, scene.size, hud.size);
+    if (bad != -1 || scene.size != 3 || hud.last != &other[1].node || other[0].node.next != &other[1].node) return 1;
+#endif
     return -1;
 }
\ No newline at end of file
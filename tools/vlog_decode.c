@@ -0,0 +1,35 @@
+#include <vlogger.h>
+#include <stdio.h>
+
+/*
+    Offline decoder for logs written with VLOG_BINARY.
+    usage: vlog_decode <binary log> [text output]
+*/
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <binary log> [text output]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (!out) {
+            fprintf(stderr, "Faild to open or create %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    long count = vloggerDecodeFile(argv[1], out);
+
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    if (count < 0) {
+        fprintf(stderr, "%s is not a binary log\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include <varena.h>
+#include <vblock.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*
+   Chunk structure (one vblock of 1 byte elements):
+   [BLOCK META]  +  [varena_chunk_t]  +  [USABLE BYTES]
+   The usable size is read back from the block metadata.
+*/
+typedef struct varena_chunk_t
+{
+    struct varena_chunk_t* next;    // Next chunk, reused before new ones are created
+    size_t pad;                     // Keeps the usable bytes 16 byte aligned
+} varena_chunk_t;
+
+struct varena_t
+{
+    varena_chunk_t* first;          // First chunk of the chain
+    varena_chunk_t* current;        // Chunk being filled
+    size_t offset;                  // Bytes used in `current`
+    size_t used;                    // Bytes handed out since the last reset
+    size_t chunk_size;              // Usable bytes of a regular chunk
+    int chained;                    // 1 if chunks are added when `current` is full
+    void* last;                     // Latest allocation, the only one that can grow or be freed
+    const vallocator_t* parent;     // Source of the chunks
+    vallocator_t allocator;         // Interface handed to containers
+};
+
+#define _varena_chunk_data(chunk) ((unsigned char*)(chunk) + sizeof(varena_chunk_t))
+#define _varena_chunk_size(chunk) (block_meta_get((block_)(chunk), BLOCK_SIZE_FIELD) - sizeof(varena_chunk_t))
+
+static void* _varena_allocator_alloc(void* ctx, size_t size, size_t align);
+static void* _varena_allocator_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align);
+static void _varena_allocator_free(void* ctx, void* ptr, size_t size);
+
+static varena_chunk_t* _varena_chunk_create(varena_t* arena, size_t size)
+{
+    varena_chunk_t* chunk = (varena_chunk_t*)_block_ctor_alloc(1, sizeof(varena_chunk_t) + size, arena->parent);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    return chunk;
+}
+
+varena_t* varena_create(size_t chunk_size, int chained)
+{
+    return varena_create_alloc(chunk_size, chained, NULL);
+}
+
+varena_t* varena_create_alloc(size_t chunk_size, int chained, const vallocator_t* parent)
+{
+    if (!chunk_size) return NULL;
+
+    parent = _vstd_allocator(parent);
+    varena_t* arena = (varena_t*)_vstd_alloc(parent, VSTD_MEM_VBLOCK, sizeof(varena_t), 0);
+    if (!arena) return NULL;
+    memset(arena, 0, sizeof(varena_t));
+
+    arena->chunk_size = chunk_size;
+    arena->chained = chained;
+    arena->parent = parent;
+    arena->allocator.alloc = _varena_allocator_alloc;
+    arena->allocator.realloc = _varena_allocator_realloc;
+    arena->allocator.free = _varena_allocator_free;
+    arena->allocator.ctx = arena;
+
+    arena->first = _varena_chunk_create(arena, chunk_size);
+    if (!arena->first) {
+        _vstd_release(parent, VSTD_MEM_VBLOCK, arena, sizeof(varena_t), 0);
+        return NULL;
+    }
+    arena->current = arena->first;
+    return arena;
+}
+
+// Returns the padding that aligns the next allocation in `chunk` at `offset`
+static size_t _varena_padding(varena_chunk_t* chunk, size_t offset, size_t align)
+{
+    uintptr_t address = (uintptr_t)(_varena_chunk_data(chunk) + offset);
+    return (size_t)((align - (address & (align - 1))) & (align - 1));
+}
+
+void* varena_alloc(varena_t* arena, size_t size, size_t align)
+{
+    if (!arena) return NULL;
+    if (!align) align = VARENA_DEFAULT_ALIGN;
+    assert((align & (align - 1)) == 0 && "alignment has to be a power of two");
+
+    varena_chunk_t* chunk = arena->current;
+    size_t offset = arena->offset;
+    size_t padding = _varena_padding(chunk, offset, align);
+
+    // Move on to a chunk with room: a kept one if it is big enough, a new one otherwise
+    while (offset + padding + size > _varena_chunk_size(chunk)) {
+        if (!arena->chained) return NULL;
+
+        varena_chunk_t* next = chunk->next;
+        if (!next || _varena_chunk_size(next) < size + align) {
+            size_t chunk_size = (size + align > arena->chunk_size)? size + align : arena->chunk_size;
+            varena_chunk_t* fresh = _varena_chunk_create(arena, chunk_size);
+            if (!fresh) return NULL;
+            fresh->next = next;
+            chunk->next = fresh;
+            next = fresh;
+        }
+        arena->used += _varena_chunk_size(chunk) - offset; // The tail of the full chunk is lost
+        chunk = next;
+        offset = 0;
+        padding = _varena_padding(chunk, offset, align);
+    }
+
+    unsigned char* ptr = _varena_chunk_data(chunk) + offset + padding;
+    arena->current = chunk;
+    arena->offset = offset + padding + size;
+    arena->used += padding + size;
+    arena->last = ptr;
+    return ptr;
+}
+
+void* varena_calloc(varena_t* arena, size_t size, size_t align)
+{
+    void* ptr = varena_alloc(arena, size, align);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+}
+
+char* varena_strdup(varena_t* arena, const char* str)
+{
+    if (!str) return NULL;
+    size_t size = strlen(str) + 1;
+    char* copy = (char*)varena_alloc(arena, size, 1);
+    if (copy) memcpy(copy, str, size);
+    return copy;
+}
+
+varena_mark_t varena_mark(varena_t* arena)
+{
+    varena_mark_t mark = { NULL, 0, 0 };
+    if (!arena) return mark;
+    mark.chunk = arena->current;
+    mark.offset = arena->offset;
+    mark.used = arena->used;
+    return mark;
+}
+
+void varena_rewind(varena_t* arena, varena_mark_t mark)
+{
+    if (!arena) return;
+    if (!mark.chunk) {
+        varena_reset(arena);
+        return;
+    }
+    arena->current = (varena_chunk_t*)mark.chunk;
+    arena->offset = mark.offset;
+    arena->used = mark.used;
+    arena->last = NULL;
+}
+
+void varena_reset(varena_t* arena)
+{
+    if (!arena) return;
+    arena->current = arena->first;
+    arena->offset = 0;
+    arena->used = 0;
+    arena->last = NULL;
+}
+
+void varena_trim(varena_t* arena)
+{
+    if (!arena) return;
+
+    varena_chunk_t* chunk = arena->first->next;
+    while (chunk) {
+        varena_chunk_t* next = chunk->next;
+        block_dtor((block_)chunk);
+        chunk = next;
+    }
+    arena->first->next = NULL;
+    varena_reset(arena);
+}
+
+size_t varena_used(varena_t* arena)
+{
+    return (arena)? arena->used : 0;
+}
+
+size_t varena_capacity(varena_t* arena)
+{
+    if (!arena) return 0;
+
+    size_t capacity = 0;
+    for (varena_chunk_t* chunk = arena->first; chunk; chunk = chunk->next) {
+        capacity += _varena_chunk_size(chunk);
+    }
+    return capacity;
+}
+
+/*
+    vallocator_t interface:
+    The latest allocation can grow in place and be given back,
+    anything older is released by the next rewind or reset.
+*/
+static void* _varena_allocator_alloc(void* ctx, size_t size, size_t align)
+{
+    return varena_alloc((varena_t*)ctx, size, align);
+}
+
+static void* _varena_allocator_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align)
+{
+    varena_t* arena = (varena_t*)ctx;
+    if (!ptr) return varena_alloc(arena, new_size, align);
+
+    if (ptr == arena->last) {
+        size_t offset = (size_t)((unsigned char*)ptr - _varena_chunk_data(arena->current));
+        if (offset + new_size <= _varena_chunk_size(arena->current)) {
+            arena->offset = offset + new_size;
+            arena->used = arena->used - old_size + new_size;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = varena_alloc(arena, new_size, align);
+    if (!new_ptr) return NULL;
+    memcpy(new_ptr, ptr, (old_size < new_size)? old_size : new_size);
+    return new_ptr;
+}
+
+static void _varena_allocator_free(void* ctx, void* ptr, size_t size)
+{
+    varena_t* arena = (varena_t*)ctx;
+    if (!ptr || ptr != arena->last) return;
+
+    arena->offset = (size_t)((unsigned char*)ptr - _varena_chunk_data(arena->current));
+    arena->used -= size;
+    arena->last = NULL;
+}
+
+const vallocator_t* varena_allocator(varena_t* arena)
+{
+    return (arena)? &arena->allocator : NULL;
+}
+
+void varena_destroy(varena_t** arena)
+{
+    if (arena && *arena)
+    {
+        varena_chunk_t* chunk = (*arena)->first;
+        while (chunk) {
+            varena_chunk_t* next = chunk->next;
+            block_dtor((block_)chunk);
+            chunk = next;
+        }
+        _vstd_release((*arena)->parent, VSTD_MEM_VBLOCK, *arena, sizeof(varena_t), 0);
+        *arena = NULL;
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef __varena__
+#define __varena__
+#include <stdint.h>
+#include <stddef.h>
+#include <vmem.h>
+
+//Alignment of allocations made without one
+#define VARENA_DEFAULT_ALIGN (16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Linear (bump pointer) allocator
+ * Memory comes from vblock chunks and is handed out front to back. Single allocations
+ * are never freed, the arena is rewound to a mark or reset as a whole instead, so a
+ * frame's temporaries cost one reset instead of one free each.
+ * @note Not thread safe, give each thread (or frame) its own arena.
+*/
+typedef struct varena_t varena_t;
+
+/**
+ * @brief Position in an arena, see varena_mark and varena_rewind.
+*/
+typedef struct varena_mark_t
+{
+    void* chunk;    // Chunk that was being filled (NULL = none yet)
+    size_t offset;  // Bytes used in that chunk
+    size_t used;    // Bytes handed out by the whole arena
+} varena_mark_t;
+
+/**
+ * @brief Creates an arena.
+ *
+ * @param chunk_size Usable bytes of each chunk.
+ * @param chained 1 to add chunks when the current one is full, 0 to fail allocations instead.
+ * @return Pointer to the newly created arena, or NULL if creation fails.
+*/
+varena_t* varena_create(size_t chunk_size, int chained);
+
+/**
+ * @brief Creates an arena whose header and chunks come from `parent`.
+ *
+ * @param chunk_size Usable bytes of each chunk.
+ * @param chained 1 to add chunks when the current one is full, 0 to fail allocations instead.
+ * @param parent Allocator of the chunks, NULL for vallocator_default(). It has to outlive the arena.
+ * @return Pointer to the newly created arena, or NULL if creation fails.
+*/
+varena_t* varena_create_alloc(size_t chunk_size, int chained, const vallocator_t* parent);
+
+/**
+ * @brief Allocates `size` bytes.
+ *
+ * @param arena Pointer to the arena.
+ * @param size Number of bytes.
+ * @param align Power of two alignment, 0 for VARENA_DEFAULT_ALIGN.
+ * @return Pointer to the memory, or NULL if the arena is full (and not chained) or out of memory.
+*/
+void* varena_alloc(varena_t* arena, size_t size, size_t align);
+
+/**
+ * @brief Allocates `size` zeroed bytes, see varena_alloc.
+*/
+void* varena_calloc(varena_t* arena, size_t size, size_t align);
+
+/**
+ * @brief Allocates `count` zeroed elements of type T.
+*/
+#define varena_new(arena, T, count) (T*)varena_calloc(arena, (count) * sizeof(T), 0)
+
+/**
+ * @brief Copies a string into the arena.
+ *
+ * @return The copy, or NULL on failure.
+*/
+char* varena_strdup(varena_t* arena, const char* str);
+
+/**
+ * @brief Returns the current position, everything allocated after it is released by varena_rewind.
+*/
+varena_mark_t varena_mark(varena_t* arena);
+
+/**
+ * @brief Releases everything allocated since `mark` was taken.
+ * Marks taken after `mark` become invalid.
+*/
+void varena_rewind(varena_t* arena, varena_mark_t mark);
+
+/**
+ * @brief Releases every allocation. The chunks are kept for the next frame.
+*/
+void varena_reset(varena_t* arena);
+
+/**
+ * @brief Frees every chunk but the first, e.g. after a frame that needed far more than usual.
+*/
+void varena_trim(varena_t* arena);
+
+/**
+ * @brief Returns the number of bytes handed out since the last reset (including alignment padding).
+*/
+size_t varena_used(varena_t* arena);
+
+/**
+ * @brief Returns the number of usable bytes of every chunk together.
+*/
+size_t varena_capacity(varena_t* arena);
+
+/**
+ * @brief Returns an allocator that allocates from the arena, for the *_create_alloc functions.
+ * Frees only give memory back if they release the latest allocation, and reallocs of the
+ * latest allocation grow in place. It stays valid until the arena is destroyed.
+*/
+const vallocator_t* varena_allocator(varena_t* arena);
+
+/**
+ * @brief Destroys the arena and frees every chunk.
+ *
+ * @param arena Pointer to the pointer of the arena, set to NULL.
+*/
+void varena_destroy(varena_t** arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __varena__
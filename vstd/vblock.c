@@ -1,22 +1,37 @@
 #include <vblock.h>
+#include <vmem.h>
 #include <stdlib.h>
 #include <string.h>
-#define META_SIZE (sizeof(size_t) * 2)
+// count, stride, allocator and padding, so the block part stays 16 byte aligned
+#define META_SIZE (sizeof(size_t) * 4)
+// Slot of the allocator in the metadata area
+#define META_ALLOCATOR 2
 
 void block_meta_set(block_ block, BLOCK_META index, size_t val);
 
+// Allocator the block came from
+#define block_allocator(block) ((const vallocator_t*)block_meta_get(block, BLOCK_ALLOCATOR_FIELD))
+
 block_ _block_ctor(size_t stride, size_t count)
+{
+    return _block_ctor_alloc(stride, count, NULL);
+}
+
+block_ _block_ctor_alloc(size_t stride, size_t count, const vallocator_t* allocator)
 {
     size_t block_size = stride * count;
+    allocator = _vstd_allocator(allocator);
     // Allocate memory for metadata and the actual block
-    unsigned char* ptr = (unsigned char*)calloc(1, META_SIZE + block_size);
+    unsigned char* ptr = (unsigned char*)_vstd_alloc(allocator, VSTD_MEM_VBLOCK, META_SIZE + block_size, 0);
     if (!ptr) return NULL;
+    memset(ptr, 0, META_SIZE + block_size);
     // Point to the actual block(skiping the meta data)
     block_ block = (block_)(ptr + META_SIZE);
 
-    // Store the block count and stride in the metadata area
+    // Store the block count, stride and allocator in the metadata area
     block_meta_set(block, BLOCK_COUNT_FIELD, count);
     block_meta_set(block, BLOCK_STRIDE_FIELD, stride);
+    ((size_t*)ptr)[META_ALLOCATOR] = (size_t)allocator;
 
     // Return the pointer to the block part
     return block;
@@ -33,7 +48,8 @@ block_ _block_cctor(block_ block)
     // Get the size of the whole memory chunk
     size_t size_all = block_meta_get(block, BLOCK_SIZE_AND_META_SIZE_FIELD);
     // Allocate new -> [[META PART] + [BLOCK PART]]  
-    unsigned char* meta_and_block = malloc(size_all);
+    unsigned char* meta_and_block = _vstd_alloc(block_allocator(block), VSTD_MEM_VBLOCK, size_all, 0);
+    if (!meta_and_block) return NULL;
     // Copy the formate of bits to the newly memory chunk
     meta_and_block = memcpy(meta_and_block, ((unsigned char *)block) - META_SIZE,  size_all);
     // Adjust pointers numeric value so it only points the block part [META PART]------->[BLOCK PART]
@@ -61,6 +77,10 @@ size_t block_meta_get(block_ block, BLOCK_META index)
         case BLOCK_SIZE_AND_META_SIZE_FIELD:
             // Calculate the total size including metadata
             return META_SIZE + (meta[BLOCK_STRIDE_FIELD] * meta[BLOCK_COUNT_FIELD]);
+
+        case BLOCK_ALLOCATOR_FIELD:
+            // Return the allocator the block came from
+            return meta[META_ALLOCATOR];
         
         default:
             // Return the value from the metadata array for other indices
@@ -73,10 +93,12 @@ block_ block_rector(block_ block, size_t stride, size_t count) {
 
     // Calculate new block size
     size_t new_block_size = stride * count;
+    size_t old_size_all = block_meta_get(block, BLOCK_SIZE_AND_META_SIZE_FIELD);
 
     // Reallocate the memory block with the new size including metadata
-    block = (block_)realloc(block, new_block_size);
-    if (block == NULL) return NULL; 
+    unsigned char* ptr = (unsigned char*)_vstd_resize(block_allocator(block), VSTD_MEM_VBLOCK, ((unsigned char*)block) - META_SIZE, old_size_all, META_SIZE + new_block_size, 0);
+    if (ptr == NULL) return NULL; 
+    block = (block_)(ptr + META_SIZE);
     // Store the block count and stride in the metadata area
     block_meta_set(block, BLOCK_COUNT_FIELD, count);
     block_meta_set(block, BLOCK_STRIDE_FIELD, stride);
@@ -92,9 +114,10 @@ block_ block_rector_pb(block_ block, size_t stride, size_t count) {
     size_t old_block_size = block_meta_get(block, BLOCK_SIZE_FIELD);
     // Calculate the new size of the block based on type size and count
     size_t new_block_size = stride * count;
-    block = (block_)realloc(block, new_block_size);
+    unsigned char* ptr = (unsigned char*)_vstd_resize(block_allocator(block), VSTD_MEM_VBLOCK, ((unsigned char*)block) - META_SIZE, META_SIZE + old_block_size, META_SIZE + new_block_size, 0);
 
-    if (block == NULL) return NULL;  
+    if (ptr == NULL) return NULL;  
+    block = (block_)(ptr + META_SIZE);
     
     // If the new block size is larger than the old block size, handle the gap space
     if (new_block_size > old_block_size) {
@@ -116,5 +139,5 @@ block_ block_rector_pb(block_ block, size_t stride, size_t count) {
 
 void block_dtor(block_ block)
 {
-    free((void*)(((unsigned char*)block) - META_SIZE));
+    _vstd_release(block_allocator(block), VSTD_MEM_VBLOCK, (void*)(((unsigned char*)block) - META_SIZE), block_meta_get(block, BLOCK_SIZE_AND_META_SIZE_FIELD), 0);
 }
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <vmem.h>
 /**
  * @brief Provides extended functionality for manipulating memory
  * tracks memory in a user frienly way unlike malloc
@@ -8,7 +9,7 @@
 /*
    block_ structure:
    Contiguous block of memory
-     16 BYTES     STRIDE * COUNT
+     32 BYTES     STRIDE * COUNT
    [META PART]  +  [BLOCK PART] 
 */
 
@@ -25,7 +26,9 @@ typedef enum BLOCK_META{
    // Index for the size of hidden meta data part of the block
    BLOCK_SIZE_META = 3,
    // Index for the total size of the block (including metadata)
-   BLOCK_SIZE_AND_META_SIZE_FIELD = 4 
+   BLOCK_SIZE_AND_META_SIZE_FIELD = 4,
+   // Index for the allocator the block came from (const vallocator_t*)
+   BLOCK_ALLOCATOR_FIELD = 5
 }BLOCK_META;
 
 /* 
@@ -44,6 +47,10 @@ typedef void * block_;
 // Returns a pointer to the newly allocated block
 block_ _block_ctor(size_t stride, size_t count);
 
+// Creates a new block of memory like _block_ctor, taken from `allocator` (NULL = vallocator_default())
+// Copies and reallocations of the block use the same allocator
+block_ _block_ctor_alloc(size_t stride, size_t count, const vallocator_t* allocator);
+
 // Creates a copy of memory the given block 
 // Allocates memory to hold type_size * type_count elements + secret metadata on the block
 // Returns a pointer to the newly allocated block
@@ -56,6 +63,9 @@ size_t block_meta_get(block_ block, BLOCK_META index);
 // Returns a pointer to the newly allocated block, skiping meta data
 #define block_ctor(type, type_count) _block_ctor(sizeof(type), type_count)
 
+// Creates a new block of memory for type_count elements of type, taken from `allocator`
+#define block_ctor_alloc(type, type_count, allocator) _block_ctor_alloc(sizeof(type), type_count, allocator)
+
 // Reallocates a block of memory, updating its size based on type size and count
 // Adjusts the size of the existing block to accommodate new type_size * type_count elements
 // Returns a pointer to the reallocated block
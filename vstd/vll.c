@@ -1,4 +1,5 @@
 #include <vll.h>
+#include <vmem.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -26,10 +27,21 @@ typedef struct vl_t
    char data[]; //generic
 } vl_t;
 
-// Creates a new link/node using the size of the user data + space for 'prev' and 'next' pointers.
-#define _vl_create(user_data_size) (vl_t*)malloc(sizeof(vl_t) + user_data_size)
-// Destroys a link/node.
-#define _vl_destroy(_mem) free(_mem)
+/*
+    Link pool:
+    Once a list reaches its pool threshold, links come from slabs of
+    the list's allocator and freed links go onto an intrusive free list
+    (chained through `next`) instead of back to the allocator. Links
+    allocated one by one before that are "loose" and still freed singly.
+    [vl_slab_t] + [link] + [link] + ... each link rounded up to VL_LINK_ALIGN
+*/
+typedef struct vl_slab_t
+{
+    struct vl_slab_t* next;     // Next (older) slab
+    size_t count;               // Number of links in the slab
+} vl_slab_t;
+
+#define VL_LINK_ALIGN (sizeof(void*) * 2)
 
 typedef struct vll_t
 {
@@ -38,6 +50,16 @@ typedef struct vll_t
     size_t size;            // Number of items
     vl_t* first;           // Pointer to the first link in the ll
     vl_t* last;            // Pointer to the last link in the ll
+    const vallocator_t* allocator; // Source of the header and every link
+    vl_t* free_links;       // Pooled links ready for reuse
+    vl_slab_t* slabs;       // Slabs of the link pool, newest first
+    size_t loose;           // Live links that were allocated one by one
+    size_t pool_threshold;  // Length at which links start coming from the pool
+    size_t unroll;          // Items per link in unrolled mode (0 = one item per link)
+    vl_t** skip;            // Skip index, skip[i] is the link at position i * skip_step
+    size_t skip_count;      // Leading checkpoints of `skip` that are still valid
+    size_t skip_capacity;   // Checkpoints `skip` has room for
+    size_t skip_step;       // Positions between checkpoints (0 = no skip index)
 } vll_t;
 
 typedef struct _vll1_t
@@ -47,6 +69,16 @@ typedef struct _vll1_t
     size_t size;            // Number of items
     vl_t* first;           // Pointer to the first link in the ll
     vl_t* last;            // Pointer to the last link in the ll
+    const vallocator_t* allocator; // Source of the header and every link
+    vl_t* free_links;       // Pooled links ready for reuse
+    vl_slab_t* slabs;       // Slabs of the link pool, newest first
+    size_t loose;           // Live links that were allocated one by one
+    size_t pool_threshold;  // Length at which links start coming from the pool
+    size_t unroll;          // Items per link in unrolled mode (0 = one item per link)
+    vl_t** skip;            // Skip index, skip[i] is the link at position i * skip_step
+    size_t skip_count;      // Leading checkpoints of `skip` that are still valid
+    size_t skip_capacity;   // Checkpoints `skip` has room for
+    size_t skip_step;       // Positions between checkpoints (0 = no skip index)
 
     // version 1.0 stuff
 
@@ -55,6 +87,99 @@ typedef struct _vll1_t
     vll1_dtor_t  dtor;  // Element Destructor
 } _vll1_t;
 
+/*
+    Unrolled mode:
+    Each link holds up to `unroll` items back to back behind a small header,
+    so a scan touches one link per `unroll` items. Items are moved with memmove
+    when a link is split, merged or a gap is closed, so pointers to items
+    only stay valid until the next insert or erase.
+    [next][prev][count][pad][item 0][item 1]...[item unroll - 1]
+*/
+#define VLU_HEADER (sizeof(size_t) * 2)
+#define _vlu_count(link) (*(size_t*)(link)->data)
+#define _vlu_item(ll, link, i) ((link)->data + VLU_HEADER + (i) * (ll)->stride)
+
+// Bytes of data behind the 'prev' and 'next' pointers of a link of `ll`
+#define _vl_data_size(ll) (((ll)->unroll)? VLU_HEADER + (ll)->unroll * (ll)->stride : (ll)->stride)
+
+// Size of a link of `ll` in a slab
+#define _vl_pooled_size(ll) ((sizeof(vl_t) + _vl_data_size(ll) + VL_LINK_ALIGN - 1) & ~(VL_LINK_ALIGN - 1))
+
+// Adds a slab twice the size of the last one to the pool
+static int _vll_pool_grow(vll_t* ll)
+{
+    size_t count = (ll->slabs)? ll->slabs->count * 2 : VLL_POOL_SLAB;
+    size_t link_size = _vl_pooled_size(ll);
+
+    vl_slab_t* slab = (vl_slab_t*)_vstd_alloc(ll->allocator, VSTD_MEM_VLL, sizeof(vl_slab_t) + count * link_size, 0);
+    if (!slab) return -1;
+    slab->count = count;
+    slab->next = ll->slabs;
+    ll->slabs = slab;
+
+    // Pushed back to front, so links are handed out in address order
+    char* links = (char*)(slab + 1);
+    for (size_t i = count; i-- > 0;) {
+        vl_t* link = (vl_t*)(links + i * link_size);
+        link->next = ll->free_links;
+        ll->free_links = link;
+    }
+    return 0;
+}
+
+// Returns 1 if `link` lives in one of the slabs of `ll`
+static int _vll_pool_owns(vll_t* ll, vl_t* link)
+{
+    size_t link_size = _vl_pooled_size(ll);
+    for (vl_slab_t* slab = ll->slabs; slab; slab = slab->next) {
+        char* links = (char*)(slab + 1);
+        if ((char*)link >= links && (char*)link < links + slab->count * link_size) return 1;
+    }
+    return 0;
+}
+
+// Frees every slab of the pool, the list has to be empty
+static void _vll_pool_free(vll_t* ll)
+{
+    size_t link_size = _vl_pooled_size(ll);
+    while (ll->slabs) {
+        vl_slab_t* slab = ll->slabs;
+        ll->slabs = slab->next;
+        _vstd_release(ll->allocator, VSTD_MEM_VLL, slab, sizeof(vl_slab_t) + slab->count * link_size, 0);
+    }
+    ll->free_links = NULL;
+}
+
+// Creates a new link/node of `ll` using the size of the user data + space for 'prev' and 'next' pointers.
+static vl_t* _vl_create(vll_t* ll)
+{
+    if (!ll->free_links && (ll->slabs || ll->size >= ll->pool_threshold)) {
+        if (_vll_pool_grow(ll) == -1) return NULL;
+    }
+    if (ll->free_links) {
+        vl_t* link = ll->free_links;
+        ll->free_links = link->next;
+        return link;
+    }
+
+    vl_t* link = (vl_t*)_vstd_alloc(ll->allocator, VSTD_MEM_VLL, sizeof(vl_t) + _vl_data_size(ll), 0);
+    if (link) ll->loose++;
+    return link;
+}
+
+// Destroys a link/node of `ll`.
+static void _vl_destroy(vll_t* ll, vl_t* link)
+{
+    // Once every loose link is gone, all links are pooled and no lookup is needed
+    if (ll->loose && !_vll_pool_owns(ll, link)) {
+        _vstd_release(ll->allocator, VSTD_MEM_VLL, link, sizeof(vl_t) + _vl_data_size(ll), 0);
+        ll->loose--;
+        return;
+    }
+    link->next = ll->free_links;
+    ll->free_links = link;
+}
+
 /*@note memory is preallocated*/
 int __def_vll_ctor(void *self, size_t size, va_list args, size_t count) 
 {
@@ -81,8 +206,14 @@ void __def_vll_dtor(void *self, size_t size)
 }
 
 vll_t* _vll_create(size_t stride, size_t initial_size)
+{
+    return _vll_create_alloc(stride, initial_size, NULL);
+}
+
+vll_t* _vll_create_alloc(size_t stride, size_t initial_size, const vallocator_t* allocator)
 {    
-    vll_t* ll = (vll_t*)malloc(sizeof(vll_t));
+    allocator = _vstd_allocator(allocator);
+    vll_t* ll = (vll_t*)_vstd_alloc(allocator, VSTD_MEM_VLL, sizeof(vll_t), 0);
     if (!ll) return NULL;
 
     ll->ver = 0;
@@ -90,23 +221,36 @@ vll_t* _vll_create(size_t stride, size_t initial_size)
     ll->size = initial_size;
     ll->first = NULL;
     ll->last = NULL;
+    ll->allocator = allocator;
+    ll->free_links = NULL;
+    ll->slabs = NULL;
+    ll->loose = 0;
+    ll->pool_threshold = VLL_POOL_THRESHOLD;
+    ll->unroll = 0;
+    ll->skip = NULL;
+    ll->skip_count = 0;
+    ll->skip_capacity = 0;
+    ll->skip_step = VLL_SKIP_STEP;
     
     if (initial_size > 0) {
         vl_t* prev = NULL;
 
         for (size_t i = 0; i < initial_size; i++) 
         {
-            vl_t* next = _vl_create(stride);
-            if (!next || (__def_vll_ctor(&next, stride, NULL, 0) == -1)) {
+            vl_t* next = _vl_create(ll);
+            if (!next || (__def_vll_ctor(next->data, stride, NULL, 0) == -1)) {
                 while (ll->first) {
                     vl_t* temp = ll->first;
                     ll->first = temp->next;
-                    _vl_destroy(temp);
+                    _vl_destroy(ll, temp);
                 }
-                free(ll);
+                _vll_pool_free(ll);
+                _vstd_release(allocator, VSTD_MEM_VLL, ll, sizeof(*ll), 0);
                 return NULL;
             }
 
+            next->next = NULL;
+            next->prev = NULL;
             if (!ll->first) {
                 ll->first = next; // first link
             } else {
@@ -122,17 +266,59 @@ vll_t* _vll_create(size_t stride, size_t initial_size)
     return ll;
 }
 
+// Items per link for `unroll` 0: enough to fill about VLL_UNROLL_BYTES
+static size_t _vll_unroll_count(size_t stride, size_t unroll)
+{
+    if (!unroll) unroll = (stride && stride < VLL_UNROLL_BYTES)? VLL_UNROLL_BYTES / stride : 1;
+    return (unroll < 2)? 2 : unroll;
+}
+
+vll_t* _vll_create_unrolled(size_t stride, size_t unroll, const vallocator_t* allocator)
+{
+    if (stride == 0) return NULL;
+    vll_t* ll = _vll_create_alloc(stride, 0, allocator);
+    if (!ll) return NULL;
+    ll->unroll = _vll_unroll_count(stride, unroll);
+    ll->skip_step = 0;
+    return ll;
+}
+
+vll1_t* _vll1_create_unrolled(size_t stride, size_t unroll, const vallocator_t* allocator, vll1_ctor_t ctor, vll1_cctor_t cctor, vll1_dtor_t dtor)
+{
+    vll1_t* ll = _vll1_create_alloc(stride, 0, allocator, ctor, cctor, dtor);
+    if (!ll) return NULL;
+    ll->unroll = _vll_unroll_count(stride, unroll);
+    ll->skip_step = 0;
+    return ll;
+}
+
 vll1_t* _vll1_create(size_t stride, size_t initial_size, vll1_ctor_t ctor, vll1_cctor_t cctor, vll1_dtor_t dtor)
+{
+    return _vll1_create_alloc(stride, initial_size, NULL, ctor, cctor, dtor);
+}
+
+vll1_t* _vll1_create_alloc(size_t stride, size_t initial_size, const vallocator_t* allocator, vll1_ctor_t ctor, vll1_cctor_t cctor, vll1_dtor_t dtor)
 {    
     if(stride == 0) return NULL;
-    _vll1_t* ll = (_vll1_t*)malloc(sizeof(_vll1_t));
+    allocator = _vstd_allocator(allocator);
+    _vll1_t* ll = (_vll1_t*)_vstd_alloc(allocator, VSTD_MEM_VLL, sizeof(_vll1_t), 0);
     if (!ll) return NULL;
 
     ll->ver = 1;
     ll->stride = stride;
-    ll->size = 0;
+    ll->size = initial_size;
     ll->first = NULL;
     ll->last = NULL;
+    ll->allocator = allocator;
+    ll->free_links = NULL;
+    ll->slabs = NULL;
+    ll->loose = 0;
+    ll->pool_threshold = VLL_POOL_THRESHOLD;
+    ll->unroll = 0;
+    ll->skip = NULL;
+    ll->skip_count = 0;
+    ll->skip_capacity = 0;
+    ll->skip_step = VLL_SKIP_STEP;
     ll->ctor = (ctor)? ctor : __def_vll_ctor;  
     ll->cctor = (cctor)? cctor : __def_vll_cctor;  
     ll->dtor = (dtor)? dtor : __def_vll_dtor;
@@ -142,17 +328,20 @@ vll1_t* _vll1_create(size_t stride, size_t initial_size, vll1_ctor_t ctor, vll1_
 
         for (size_t i = 0; i < initial_size; i++) 
         {
-            vl_t* next = _vl_create(stride);
-            if (!next || (__def_vll_ctor(&next, stride, NULL, 0) == -1)) {
+            vl_t* next = _vl_create((vll_t*)ll);
+            if (!next || (__def_vll_ctor(next->data, stride, NULL, 0) == -1)) {
                 while (ll->first) {
                     vl_t* temp = ll->first;
                     ll->first = temp->next;
-                    _vl_destroy(temp);
+                    _vl_destroy((vll_t*)ll, temp);
                 }
-                free(ll);
+                _vll_pool_free((vll_t*)ll);
+                _vstd_release(allocator, VSTD_MEM_VLL, ll, sizeof(*ll), 0);
                 return NULL;
             }
 
+            next->next = NULL;
+            next->prev = NULL;
             if (!ll->first) {
                 ll->first = next; // first link
             } else {
@@ -176,6 +365,9 @@ size_t vll_get_field(vll_t* ll, VLL_FIELD field)
         case VLL_FIELD_VER:          return ll->ver;
         case VLL_FIELD_STRIDE:       return ll->stride;
         case VLL_FIELD_LENGTH:       return ll->size;
+        case VLL_FIELD_POOL_THRESHOLD: return ll->pool_threshold;
+        case VLL_FIELD_UNROLL:       return ll->unroll;
+        case VLL_FIELD_SKIP_STEP:    return ll->skip_step;
         default:                     break;
     }
 
@@ -193,17 +385,60 @@ size_t vll_get_field(vll_t* ll, VLL_FIELD field)
 
 // Internal
 
+// Size of the header allocation
+#define _vll_header_size(ll) (((ll)->ver == VLL_VER_1_0)? sizeof(_vll1_t) : sizeof(vll_t))
+
+/*
+    Skip index:
+    Plain lists remember the link at every skip_step'th position the first time a
+    lookup walks past it, so later lookups start at most half a step away.
+    Changes at `index` only drop the checkpoints from `index` on (appends keep
+    all of them), the next lookup that needs them walks and records them again.
+*/
+
+// Drops the checkpoints at positions >= `index`
+static void _vll_skip_cut(vll_t* ll, size_t index)
+{
+    if (!ll->skip_step) return;
+    size_t keep = (index + ll->skip_step - 1) / ll->skip_step;
+    if (keep < ll->skip_count) ll->skip_count = keep;
+}
+
+// Frees the skip index
+static void _vll_skip_free(vll_t* ll)
+{
+    _vstd_release(ll->allocator, VSTD_MEM_VLL, ll->skip, ll->skip_capacity * sizeof(vl_t*), 0);
+    ll->skip = NULL;
+    ll->skip_count = 0;
+    ll->skip_capacity = 0;
+}
+
+// Makes room for `count` checkpoints
+static int _vll_skip_reserve(vll_t* ll, size_t count)
+{
+    if (count <= ll->skip_capacity) return 0;
+
+    size_t capacity = (ll->skip_capacity)? ll->skip_capacity * 2 : 16;
+    if (capacity < count) capacity = count;
+    vl_t** skip = (vl_t**)_vstd_resize(ll->allocator, VSTD_MEM_VLL, ll->skip,
+        ll->skip_capacity * sizeof(vl_t*), capacity * sizeof(vl_t*), 0);
+    if (!skip) return -1;
+    ll->skip = skip;
+    ll->skip_capacity = capacity;
+    return 0;
+}
+
 static int _vll_to_ver(vll_t* ll, size_t ver) /*no ptr check*/
 {
     if(ver == VLL_VER_1_0){
-        _vll1_t* new_data = (_vll1_t*)realloc(ll, sizeof(_vll1_t));
+        _vll1_t* new_data = (_vll1_t*)_vstd_resize(ll->allocator, VSTD_MEM_VLL, ll, _vll_header_size(ll), sizeof(_vll1_t), 0);
         new_data->ctor = __def_vll_ctor;
         new_data->cctor = __def_vll_cctor;
         new_data->dtor = __def_vll_dtor;
         new_data->ver = ver;
         if(!new_data) return -1;
     }else if(ver == VLL_VER_0_0){
-        vll_t* new_data = (vll_t*)realloc(ll, sizeof(vll_t));
+        vll_t* new_data = (vll_t*)_vstd_resize(ll->allocator, VSTD_MEM_VLL, ll, _vll_header_size(ll), sizeof(vll_t), 0);
         new_data->ver = ver;
         if(!new_data) return -1;
     }else{
@@ -213,12 +448,253 @@ static int _vll_to_ver(vll_t* ll, size_t ver) /*no ptr check*/
     return 0; //Things went well
 }
 
+// Links `link` in after `prev` (NULL = at the front)
+static void _vl_link_after(vll_t* ll, vl_t* prev, vl_t* link)
+{
+    link->prev = prev;
+    link->next = (prev)? prev->next : ll->first;
+    if (link->next) link->next->prev = link;
+    else ll->last = link;
+    if (prev) prev->next = link;
+    else ll->first = link;
+}
+
+// Takes `link` out of the chain
+static void _vl_unlink(vll_t* ll, vl_t* link)
+{
+    if (link->prev) link->prev->next = link->next;
+    else ll->first = link->next;
+    if (link->next) link->next->prev = link->prev;
+    else ll->last = link->prev;
+}
+
+// Finds the unrolled link holding item `index`, `offset` receives the position of the item in it
+static vl_t* _vllu_find(vll_t* ll, size_t index, size_t* offset)
+{
+    //Walks from the end closest to the target index, skipping whole links
+    if (index <= ll->size >> 1) {
+        vl_t* link = ll->first;
+        while (index >= _vlu_count(link)) {
+            index -= _vlu_count(link);
+            link = link->next;
+        }
+        *offset = index;
+        return link;
+    }
+
+    size_t back = ll->size - index; // 1 = last item
+    vl_t* link = ll->last;
+    while (back > _vlu_count(link)) {
+        back -= _vlu_count(link);
+        link = link->prev;
+    }
+    *offset = _vlu_count(link) - back;
+    return link;
+}
+
+// Moves the items of the next link into `link` if `link` is less than half full and they fit
+static void _vllu_merge_next(vll_t* ll, vl_t* link)
+{
+    vl_t* next = link->next;
+    if (!next || _vlu_count(link) >= ll->unroll / 2) return;
+    if (_vlu_count(link) + _vlu_count(next) > ll->unroll) return;
+
+    memcpy(_vlu_item(ll, link, _vlu_count(link)), _vlu_item(ll, next, 0), _vlu_count(next) * ll->stride);
+    _vlu_count(link) += _vlu_count(next);
+    _vl_unlink(ll, next);
+    _vl_destroy(ll, next);
+}
+
+// Removes the item at `offset` of `link` without destroying it
+static void _vllu_close(vll_t* ll, vl_t* link, size_t offset)
+{
+    size_t count = _vlu_count(link);
+    char* slot = _vlu_item(ll, link, offset);
+    memmove(slot, slot + ll->stride, (count - offset - 1) * ll->stride);
+    _vlu_count(link) = count - 1;
+    ll->size--;
+
+    if (_vlu_count(link) == 0) {
+        _vl_unlink(ll, link);
+        _vl_destroy(ll, link);
+    } else {
+        _vllu_merge_next(ll, link);
+    }
+}
+
+/*
+    Opens a gap for one item at `offset` of `link` (`offset` may be the link's count, NULL link = empty list)
+    and returns it, the caller constructs the item or closes the gap again
+*/
+static char* _vllu_open_at(vll_t* ll, vl_t* link, size_t offset, vl_t** out_link, size_t* out_offset)
+{
+    if (!link || _vlu_count(link) == ll->unroll) {
+        vl_t* fresh = _vl_create(ll);
+        if (!fresh) return NULL;
+        _vlu_count(fresh) = 0;
+        _vl_link_after(ll, link, fresh);
+
+        if (link) {
+            // Split the full link in half, appending to it just starts the new link
+            size_t count = _vlu_count(link);
+            size_t keep = (offset == count)? count : count / 2;
+            memcpy(_vlu_item(ll, fresh, 0), _vlu_item(ll, link, keep), (count - keep) * ll->stride);
+            _vlu_count(fresh) = count - keep;
+            _vlu_count(link) = keep;
+            if (offset > keep || keep == count) {
+                link = fresh;
+                offset -= keep;
+            }
+        } else {
+            link = fresh;
+            offset = 0;
+        }
+    }
+
+    char* slot = _vlu_item(ll, link, offset);
+    memmove(slot + ll->stride, slot, (_vlu_count(link) - offset) * ll->stride);
+    _vlu_count(link)++;
+    ll->size++;
+
+    *out_link = link;
+    *out_offset = offset;
+    return slot;
+}
+
+// Opens a gap for one item at `index`, see _vllu_open_at
+static char* _vllu_open(vll_t* ll, size_t index, vl_t** out_link, size_t* out_offset)
+{
+    vl_t* link = ll->last;
+    size_t offset = (link)? _vlu_count(link) : 0;
+    if (index < ll->size) {
+        link = _vllu_find(ll, index, &offset);
+    }
+    return _vllu_open_at(ll, link, offset, out_link, out_offset);
+}
+
+// Copy constructs an item at `index` of an unrolled list
+static int _vllu_insert(vll_t* ll, size_t index, const void* original)
+{
+    vl_t* link;
+    size_t offset;
+    char* slot = _vllu_open(ll, index, &link, &offset);
+    if (!slot) return -1;
+
+    vll1_cctor_t __cctor = (ll->ver == VLL_VER_0_0)? __def_vll_cctor : ((_vll1_t*)ll)->cctor;
+    if (__cctor(slot, original, ll->stride) == -1) {
+        _vllu_close(ll, link, offset);
+        return -1;
+    }
+    return 0;
+}
+
+// Constructs an item in place at `index` of an unrolled list
+static int _vllu_emplace(vll_t* ll, size_t index, va_list args, size_t arg_count)
+{
+    vl_t* link;
+    size_t offset;
+    char* slot = _vllu_open(ll, index, &link, &offset);
+    if (!slot) return -1;
+
+    vll1_ctor_t __ctor = (ll->ver == VLL_VER_0_0)? __def_vll_ctor : ((_vll1_t*)ll)->ctor;
+    if (__ctor(slot, ll->stride, args, arg_count) == -1) {
+        _vllu_close(ll, link, offset);
+        return -1;
+    }
+    return 0;
+}
+
+// Destroys the items in [start, end) of an unrolled list
+static void _vllu_erase(vll_t* ll, size_t start, size_t end)
+{
+    vll1_dtor_t __dtor = (ll->ver == VLL_VER_0_0)? __def_vll_dtor : ((_vll1_t*)ll)->dtor;
+    size_t offset;
+    vl_t* link = _vllu_find(ll, start, &offset);
+    vl_t* head = (offset > 0)? link : NULL; // Keeps its first items, so it survives
+    size_t remaining = end - start;
+
+    while (remaining) {
+        size_t count = _vlu_count(link);
+        size_t n = (count - offset < remaining)? count - offset : remaining;
+        for (size_t i = offset; i < offset + n; i++) {
+            __dtor(_vlu_item(ll, link, i), ll->stride);
+        }
+        memmove(_vlu_item(ll, link, offset), _vlu_item(ll, link, offset + n), (count - offset - n) * ll->stride);
+        _vlu_count(link) = count - n;
+        ll->size -= n;
+        remaining -= n;
+
+        vl_t* next = link->next;
+        if (_vlu_count(link) == 0) {
+            _vl_unlink(ll, link);
+            _vl_destroy(ll, link);
+        }
+        link = next;
+        offset = 0;
+    }
+
+    if (head) _vllu_merge_next(ll, head);
+}
+
+// Reverses the items inside every link, the links themselves are reversed by vll_reverse
+static void _vllu_reverse_items(vll_t* ll)
+{
+    for (vl_t* link = ll->first; link; link = link->next) {
+        size_t count = _vlu_count(link);
+        for (size_t i = 0; i < count / 2; i++) {
+            unsigned char* a = (unsigned char*)_vlu_item(ll, link, i);
+            unsigned char* b = (unsigned char*)_vlu_item(ll, link, count - 1 - i);
+            for (size_t byte = 0; byte < ll->stride; byte++) {
+                unsigned char t = a[byte];
+                a[byte] = b[byte];
+                b[byte] = t;
+            }
+        }
+    }
+}
+
 static vl_t * _vll_at(vll_t* ll, ssize_t index) /*no ptr check*/
 {
     size_t nindex = (index < 0) ? (size_t)(ll->size + index) : (size_t)index;
     
     assert(nindex < ll->size && "index out-of-range");
-    
+
+    // The ends need no walk, so they never grow the skip index
+    if (nindex == 0) return ll->first;
+    if (nindex == ll->size - 1) return ll->last;
+
+    size_t skip_step = ll->skip_step;
+    if (skip_step && ll->size > skip_step) {
+        size_t slot = nindex / skip_step;
+        if (slot < ll->skip_count) {
+            // Start from the closer of the two checkpoints around `nindex`
+            size_t i = slot * skip_step;
+            vl_t* cur = ll->skip[slot];
+            if (nindex - i > skip_step / 2 && slot + 1 < ll->skip_count) {
+                i += skip_step;
+                cur = ll->skip[slot + 1];
+                while (i != nindex) { cur = cur->prev; i--; }
+            } else {
+                while (i != nindex) { cur = cur->next; i++; }
+            }
+            return cur;
+        }
+
+        // Past the recorded checkpoints: walk on from the last one, recording the rest on the
+        // way, unless the back of the list is closer
+        size_t from = (ll->skip_count)? (ll->skip_count - 1) * skip_step : 0;
+        if (ll->size - 1 - nindex >= nindex - from && _vll_skip_reserve(ll, slot + 1) == 0) {
+            if (!ll->skip_count) ll->skip[ll->skip_count++] = ll->first;
+            size_t i = from;
+            vl_t* cur = ll->skip[ll->skip_count - 1];
+            while (i != nindex) {
+                cur = cur->next;
+                if (++i % skip_step == 0) ll->skip[ll->skip_count++] = cur;
+            }
+            return cur;
+        }
+    }
+
     //Optimizes the traversal by starting from the end closest to the target index
     int step = (nindex <= ll->size >> 1) ? 1 : -1;
     vl_t* cur = (step == 1) ? ll->first : ll->last;
@@ -240,33 +716,36 @@ static void _vll_erase(vll_t* ll, ssize_t start, ssize_t end) /*no ptr check*/
     }
     size_t Ustart = (start < 0) ? (size_t)(ll->size + start) : (size_t)start;
     size_t Uend = (end < 0) ? (size_t)(ll->size + end) : (size_t)end;
+    if (ll->unroll) {
+        _vllu_erase(ll, Ustart, Uend);
+        return;
+    }
     
-    vl_t* first = _vll_at(ll, Ustart);
-    vl_t* last = (Uend == ll->size) ? NULL : _vll_at(ll, Uend);
+    // One lookup, the rest of the range is walked while it is destroyed
+    vl_t* current = _vll_at(ll, Ustart);
+    _vll_skip_cut(ll, Ustart);
+    vl_t* prev = current->prev;
+
+    vll1_dtor_t __dtor = (ll->ver == VLL_VER_0_0)? __def_vll_dtor : ((_vll1_t*)ll)->dtor;
+    for (size_t i = Ustart; i < Uend; i++) {
+        vl_t* next = current->next;
+        __dtor(current->data, ll->stride);
+        _vl_destroy(ll, current);
+        current = next;
+    }
 
-    vl_t* prev = (Ustart > 0) ? _vll_at(ll, Ustart - 1) : NULL;
-    
     if (prev) {
-        prev->next = last;
+        prev->next = current;
     } else {
-        ll->first = last;
+        ll->first = current;
     }
     
-    if (last) {
-        last->prev = prev;
+    if (current) {
+        current->prev = prev;
     } else {
         ll->last = prev;
     }
 
-    vll1_dtor_t __dtor = (ll->ver == VLL_VER_0_0)? __def_vll_dtor : ((_vll1_t*)ll)->dtor;
-    vl_t* current = first;
-    while (current != last) {
-        vl_t* next = current->next;
-        __dtor(current->data, ll->stride);
-        _vl_destroy(current);
-        current = next;
-    }
-
     ll->size -= (Uend - Ustart);
 
     if (ll->size == 0) {
@@ -285,9 +764,22 @@ static int _vll_resize(vll_t* ll, size_t new_size) /*no ptr check*/
     {
         vll1_ctor_t __cctor = (ll->ver == VLL_VER_0_0) ? __def_vll_ctor : ((_vll1_t*)ll)->ctor;
         
-        for (size_t i = current_size; i < new_size; ++i) 
+        for (size_t i = current_size; i < new_size && ll->unroll; ++i) 
         {
-            vl_t* vl = _vl_create(ll->stride);
+            vl_t* link;
+            size_t offset;
+            char* slot = _vllu_open(ll, ll->size, &link, &offset);
+            if (!slot)
+            {
+                _vll_erase(ll, current_size, ll->size);
+                return -2;
+            }
+            __cctor(slot, ll->stride, NULL, 1);
+        }
+
+        for (size_t i = ll->size; i < new_size; ++i) 
+        {
+            vl_t* vl = _vl_create(ll);
             if (!vl)
             {
                 // Rollback: remove the nodes we've added
@@ -325,6 +817,13 @@ void vll_set_field(vll_t* ll, VLL_FIELD field, size_t value)
     {
         case VLL_FIELD_VER:           {_vll_to_ver(ll, value); return;}
         case VLL_FIELD_LENGTH:        {_vll_resize(ll, value); return;}
+        case VLL_FIELD_POOL_THRESHOLD:{ll->pool_threshold = value; return;}
+        case VLL_FIELD_SKIP_STEP:     {
+            if (ll->unroll) return;
+            _vll_skip_free(ll);
+            ll->skip_step = value;
+            return;
+        }
         default: break;
     }
     if(ll->ver == VLL_VER_0_0) return;
@@ -343,8 +842,9 @@ void vll_set_field(vll_t* ll, VLL_FIELD field, size_t value)
 int vll_push_back(vll_t* ll, const void* original)
 {
     if (!ll || !original) return -1;
+    if (ll->unroll) return _vllu_insert(ll, ll->size, original);
 
-    vl_t* vl = _vl_create(ll->stride);
+    vl_t* vl = _vl_create(ll);
     if(!vl) return -1;
     vl->next = NULL;
     if(ll->size == 0){
@@ -368,8 +868,15 @@ int vll_push_back(vll_t* ll, const void* original)
 int vll_emplace_back(vll_t* ll, size_t arg_count, ...)
 {
     if(!ll || !arg_count) return -1;
+    if (ll->unroll) {
+        va_list args;
+        va_start(args, arg_count);
+        int ret = _vllu_emplace(ll, ll->size, args, arg_count);
+        va_end(args);
+        return ret;
+    }
 
-    vl_t* vl = _vl_create(ll->stride);
+    vl_t* vl = _vl_create(ll);
     if(!vl) return -1;
     vl->next = NULL;
     if(ll->size == 0){
@@ -401,31 +908,14 @@ int vll_insert(vll_t* ll, ssize_t index, const void* original)
 
     size_t nindex = (index < 0) ? (size_t)(ll->size + index) : (size_t)index;
     assert(!(nindex > ll->size) && "index out-of range");
+    if (ll->unroll) return _vllu_insert(ll, nindex, original);
 
-    vl_t* vl = _vl_create(ll->stride);
+    vl_t* vl = _vl_create(ll);
     if(!vl) return -1;
 
-    vl_t* l = _vll_at(ll, index);
-    vl->next = NULL;
-    if(ll->size == 0){
-        ll->first = (l = vl);
-        vl->prev = NULL;
-    }else{ 
-
-        if(index > 0)
-        {
-            vl->next = l;
-            vl->prev = l->prev;
-            l->prev->next = vl;
-            l->prev = vl;
-        }else{
-            vl->next = ll->first;
-            vl->prev = NULL;
-            ll->first->prev = vl;
-            ll->first = vl;
-        }
-
-    }    
+    vl_t* l = (nindex < ll->size)? _vll_at(ll, nindex) : NULL;
+    _vl_link_after(ll, (l)? l->prev : ll->last, vl);
+    _vll_skip_cut(ll, nindex);
 
     vll1_cctor_t __cctor = (ll->ver == VLL_VER_0_0)? __def_vll_cctor : ((_vll1_t*)ll)->cctor;
     if (__cctor(vl->data, original, ll->stride) == -1) return -1;
@@ -439,30 +929,19 @@ int vll_emplace(vll_t* ll, ssize_t index, size_t arg_count, ...)
 
     size_t nindex = (index < 0) ? (size_t)(ll->size + index) : (size_t)index;
     assert(!(nindex > ll->size) && "index out-of range");
+    if (ll->unroll) {
+        va_list args;
+        va_start(args, arg_count);
+        int ret = _vllu_emplace(ll, nindex, args, arg_count);
+        va_end(args);
+        return ret;
+    }
 
-    vl_t* vl = _vl_create(ll->stride);
+    vl_t* vl = _vl_create(ll);
     if(!vl) return -1;
-    vl_t* l = _vll_at(ll, index);
-    vl->next = NULL;
-    if(ll->size == 0){
-        ll->first = (l = vl);
-        vl->prev = NULL;
-    }else{ 
-
-        if(index > 0)
-        {
-            vl->next = l;
-            vl->prev = l->prev;
-            l->prev->next = vl;
-            l->prev = vl;
-        }else{
-            vl->next = ll->first;
-            vl->prev = NULL;
-            ll->first->prev = vl;
-            ll->first = vl;
-        }
-
-    }   
+    vl_t* l = (nindex < ll->size)? _vll_at(ll, nindex) : NULL;
+    _vl_link_after(ll, (l)? l->prev : ll->last, vl);
+    _vll_skip_cut(ll, nindex);
 
     vll1_ctor_t __ctor = (ll->ver == VLL_VER_0_0)? __def_vll_ctor : ((_vll1_t*)ll)->ctor;
     
@@ -479,14 +958,32 @@ int vll_emplace(vll_t* ll, ssize_t index, size_t arg_count, ...)
 
 void *vll_at(vll_t* ll, ssize_t index) {
     if (!ll || ll->size == 0) return NULL;
+    if (ll->unroll) {
+        size_t nindex = (index < 0) ? (size_t)(ll->size + index) : (size_t)index;
+        assert(nindex < ll->size && "index out-of-range");
+        size_t offset;
+        vl_t* link = _vllu_find(ll, nindex, &offset);
+        return _vlu_item(ll, link, offset);
+    }
     return _vll_at(ll, index)->data;
 }
 
 void vll_pop_at(vll_t* ll, ssize_t index)
 {
     if (!ll) return;
+    if (ll->unroll) {
+        size_t nindex = (index < 0) ? (size_t)(ll->size + index) : (size_t)index;
+        assert(nindex < ll->size && "index out-of-range");
+        size_t offset;
+        vl_t* link = _vllu_find(ll, nindex, &offset);
+        vll1_dtor_t __dtor = (ll->ver == VLL_VER_0_0) ? __def_vll_dtor : ((_vll1_t*)ll)->dtor;
+        __dtor(_vlu_item(ll, link, offset), ll->stride);
+        _vllu_close(ll, link, offset);
+        return;
+    }
     
     vl_t* l = _vll_at(ll, index);
+    _vll_skip_cut(ll, (index < 0) ? (size_t)(ll->size + index) : (size_t)index);
     
     if (l == ll->first) {
         ll->first = l->next;
@@ -502,7 +999,7 @@ void vll_pop_at(vll_t* ll, ssize_t index)
     
     vll1_dtor_t __dtor = (ll->ver == VLL_VER_0_0) ? __def_vll_dtor : ((_vll1_t*)ll)->dtor;
     __dtor(l->data, ll->stride);
-    _vl_destroy(l);
+    _vl_destroy(ll, l);
     ll->size--;
 }
 
@@ -520,6 +1017,11 @@ void vll_swap(vll_t* lhs, vll_t* rhs)
 {
     assert(lhs == rhs && "pointer are restricted from pointing to the same address");
     if(lhs->stride != rhs->stride) printf("vll Warning: stride is not the same size for {lhs} and {rhs} in file: %s line: %d", __FILE__, __LINE__);
+    //each header has to go back to the allocator it came from
+    if(lhs->allocator != rhs->allocator) {
+        printf("vll Warning: {lhs} and {rhs} use different allocators, not swapping in file: %s line: %d", __FILE__, __LINE__);
+        return;
+    }
     //swaping things like meta data and the arrary data pointers
     if(lhs->ver == VLL_VER_1_0 && rhs->ver == VLL_VER_1_0){
         vll1_t temp = *lhs;
@@ -556,6 +1058,234 @@ void vll_reverse(vll_t* ll)
     ll->first = prev;
     ll->first->prev = NULL;
     ll->last->next = NULL;
+    ll->skip_count = 0;
+
+    if (ll->unroll) _vllu_reverse_items(ll);
+}
+
+// Iterators
+
+vll_iter_t vll_iter_at(vll_t* ll, ssize_t index)
+{
+    vll_iter_t iter = { ll, NULL, 0, 0 };
+    if (!ll) return iter;
+
+    size_t nindex = (index < 0) ? (size_t)(ll->size + index) : (size_t)index;
+    if ((index < 0 && (size_t)(-index) > ll->size) || nindex >= ll->size) {
+        iter.index = ll->size;
+        return iter;
+    }
+
+    iter.index = nindex;
+    if (ll->unroll) {
+        iter.link = _vllu_find(ll, nindex, &iter.offset);
+    } else if (nindex == 0) {
+        iter.link = ll->first;
+    } else if (nindex == ll->size - 1) {
+        iter.link = ll->last;
+    } else {
+        iter.link = _vll_at(ll, (ssize_t)nindex);
+    }
+    return iter;
+}
+
+int vll_iter_valid(const vll_iter_t* iter)
+{
+    return iter && iter->link;
+}
+
+void* vll_iter_get(const vll_iter_t* iter)
+{
+    if (!iter || !iter->link) return NULL;
+    vl_t* link = (vl_t*)iter->link;
+    return (iter->ll->unroll)? (void*)_vlu_item(iter->ll, link, iter->offset) : (void*)link->data;
+}
+
+int vll_iter_next(vll_iter_t* iter)
+{
+    if (!iter || !iter->link) return 0;
+
+    vl_t* link = (vl_t*)iter->link;
+    iter->index++;
+    if (iter->ll->unroll && ++iter->offset < _vlu_count(link)) return 1;
+
+    iter->link = link->next;
+    iter->offset = 0;
+    return iter->link != NULL;
+}
+
+int vll_iter_prev(vll_iter_t* iter)
+{
+    if (!iter || !iter->link) return 0;
+
+    vl_t* link = (vl_t*)iter->link;
+    if (iter->ll->unroll && iter->offset > 0) {
+        iter->offset--;
+        iter->index--;
+        return 1;
+    }
+
+    iter->link = link->prev;
+    if (!iter->link) {
+        iter->index = iter->ll->size; // Past the front
+        return 0;
+    }
+    iter->index--;
+    iter->offset = (iter->ll->unroll)? _vlu_count(link->prev) - 1 : 0;
+    return 1;
+}
+
+int vll_insert_after(vll_iter_t* iter, const void* original)
+{
+    if (!iter || !iter->ll || !original) return -1;
+
+    vll_t* ll = iter->ll;
+    if (!iter->link) return vll_push_back(ll, original);
+
+    vll1_cctor_t __cctor = (ll->ver == VLL_VER_0_0)? __def_vll_cctor : ((_vll1_t*)ll)->cctor;
+
+    if (ll->unroll) {
+        vl_t* link;
+        size_t offset;
+        char* slot = _vllu_open_at(ll, (vl_t*)iter->link, iter->offset + 1, &link, &offset);
+        if (!slot) return -1;
+
+        if (__cctor(slot, original, ll->stride) == -1) {
+            _vllu_close(ll, link, offset);
+            *iter = vll_iter_at(ll, (ssize_t)iter->index);
+            return -1;
+        }
+
+        // A split may have moved the iterator's element, it sits right before the new one
+        if (offset > 0) {
+            iter->link = link;
+            iter->offset = offset - 1;
+        } else {
+            iter->link = link->prev;
+            iter->offset = _vlu_count(link->prev) - 1;
+        }
+        return 0;
+    }
+
+    vl_t* vl = _vl_create(ll);
+    if (!vl) return -1;
+    if (__cctor(vl->data, original, ll->stride) == -1) {
+        _vl_destroy(ll, vl);
+        return -1;
+    }
+    _vl_link_after(ll, (vl_t*)iter->link, vl);
+    _vll_skip_cut(ll, iter->index + 1);
+    ll->size++;
+    return 0;
+}
+
+int vll_erase_at(vll_iter_t* iter)
+{
+    if (!iter || !iter->link) return -1;
+
+    vll_t* ll = iter->ll;
+    vl_t* link = (vl_t*)iter->link;
+    vll1_dtor_t __dtor = (ll->ver == VLL_VER_0_0)? __def_vll_dtor : ((_vll1_t*)ll)->dtor;
+
+    if (ll->unroll) {
+        vl_t* next = link->next;
+        size_t count = _vlu_count(link);
+        __dtor(_vlu_item(ll, link, iter->offset), ll->stride);
+        _vllu_close(ll, link, iter->offset);
+
+        // The link is gone if that was its last item, otherwise the next item slid into place
+        if (count == 1) {
+            iter->link = next;
+            iter->offset = 0;
+        } else if (iter->offset >= _vlu_count(link)) {
+            iter->link = link->next;
+            iter->offset = 0;
+        }
+    } else {
+        iter->link = link->next;
+        _vl_unlink(ll, link);
+        _vll_skip_cut(ll, iter->index);
+        __dtor(link->data, ll->stride);
+        _vl_destroy(ll, link);
+        ll->size--;
+    }
+
+    if (!iter->link) iter->index = ll->size;
+    return 0;
+}
+
+// Intrusive list
+
+void vlist_init(vlist_t* list)
+{
+    if (!list) return;
+    list->first = NULL;
+    list->last = NULL;
+    list->size = 0;
+}
+
+int vlist_insert_after(vlist_t* list, vlist_node* pos, vlist_node* node)
+{
+    if (!list || !node) return -1;
+    assert(!node->next && !node->prev && list->first != node && "node is already linked");
+
+    node->prev = pos;
+    node->next = (pos)? pos->next : list->first;
+    if (node->next) node->next->prev = node;
+    else list->last = node;
+    if (pos) pos->next = node;
+    else list->first = node;
+    list->size++;
+    return 0;
+}
+
+int vlist_insert_before(vlist_t* list, vlist_node* pos, vlist_node* node)
+{
+    if (!list) return -1;
+    return vlist_insert_after(list, (pos)? pos->prev : list->last, node);
+}
+
+int vlist_push_front(vlist_t* list, vlist_node* node)
+{
+    return vlist_insert_after(list, NULL, node);
+}
+
+int vlist_push_back(vlist_t* list, vlist_node* node)
+{
+    if (!list) return -1;
+    return vlist_insert_after(list, list->last, node);
+}
+
+int vlist_unlink(vlist_t* list, vlist_node* node)
+{
+    if (!list || !node || !list->size) return -1;
+    assert((node->prev || list->first == node) && (node->next || list->last == node) && "node is not linked into this list");
+    if ((!node->prev && list->first != node) || (!node->next && list->last != node)) return -1;
+
+    if (node->prev) node->prev->next = node->next;
+    else list->first = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else list->last = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+    list->size--;
+    return 0;
+}
+
+vlist_node* vlist_pop_front(vlist_t* list)
+{
+    if (!list || !list->first) return NULL;
+    vlist_node* node = list->first;
+    vlist_unlink(list, node);
+    return node;
+}
+
+vlist_node* vlist_pop_back(vlist_t* list)
+{
+    if (!list || !list->last) return NULL;
+    vlist_node* node = list->last;
+    vlist_unlink(list, node);
+    return node;
 }
 
 void vll_destroy(vll_t** ll)
@@ -563,7 +1293,9 @@ void vll_destroy(vll_t** ll)
     if (ll && *ll)
     {
         vll_clear(*ll);
-        free(*ll);
+        _vll_pool_free(*ll);
+        _vll_skip_free(*ll);
+        _vstd_release((*ll)->allocator, VSTD_MEM_VLL, *ll, _vll_header_size(*ll), 0);
         *ll = NULL;
     }
 }
\ No newline at end of file
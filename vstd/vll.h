@@ -2,6 +2,7 @@
 #define __vll__
 //@ref at: https://en.cppreference.com/w/cpp/container/list
 #include <stdint.h>
+#include <stddef.h>
 #if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
 #include <BaseTsd.h>
 typedef SSIZE_T ssize_t;
@@ -10,12 +11,33 @@ typedef SIZE_T size_t;
 #endif
 #endif
 #include <stdarg.h> // <---- will be useful for the emplace functions
+#include <vmem.h>
 
 //Represents the front index of a LINKED LIST
 #define VLL_FRONT (0)
 //Represents the back index of a LINKED LIST
 #define VLL_BACK (-1)
 
+//Lists this long allocate their links from a pool of slabs and keep freed links for reuse
+#ifndef VLL_POOL_THRESHOLD
+#define VLL_POOL_THRESHOLD 64
+#endif
+
+//Number of links in the first slab of a link pool, each new slab doubles it
+#ifndef VLL_POOL_SLAB
+#define VLL_POOL_SLAB 64
+#endif
+
+//Unrolled lists created with `unroll` 0 put about this many bytes of items in each link
+#ifndef VLL_UNROLL_BYTES
+#define VLL_UNROLL_BYTES 256
+#endif
+
+//Positions between the checkpoints of a list's skip index, vll_at walks at most half of it from one
+#ifndef VLL_SKIP_STEP
+#define VLL_SKIP_STEP 64
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,12 +63,16 @@ typedef enum VLL_FIELD /* : int*/
 
     VLL_FIELD_STRIDE          = 1, /**< Size of each element in the ll */
     VLL_FIELD_LENGTH          = 2,  /**< Current number of elements in the ll */
+    VLL_FIELD_POOL_THRESHOLD  = 3,  /**< Length at which links start coming from the list's link pool (0 = always, SIZE_MAX = never) */
+    VLL_FIELD_UNROLL          = 4,  /**< Items per link of an unrolled list, 0 for a plain list (read only) */
 
     //LINKED LIST version 1.0
 
     VLL1_FIELD_CTOR           = 5,  /**< Contructor function for each element */
     VLL1_FIELD_CCTOR          = 6,  /**< Copy contructor function for each element */
     VLL1_FIELD_DTOR           = 7,  /**< Destructor function for each element */
+
+    VLL_FIELD_SKIP_STEP       = 8,  /**< Positions between the checkpoints of the skip index used by vll_at (0 = no index, always 0 for unrolled lists) */
 } VLL_FIELD;
 
 /**
@@ -58,6 +84,49 @@ typedef struct vll_t vll_t;
 */
 typedef vll_t vll1_t;
 
+/**
+ * @brief Cursor over the elements of a vll.
+ * Stepping is O(1) in both list modes. An iterator past either end is not valid,
+ * inserts and erases through other iterators (or by index) invalidate it.
+*/
+typedef struct vll_iter_t
+{
+    vll_t* ll;          // List the iterator walks
+    void* link;         // Current link, NULL past either end
+    size_t offset;      // Position inside an unrolled link
+    size_t index;       // Position of the element in the list
+} vll_iter_t;
+
+/**
+ * @brief Node of an intrusive list, embedded in the user's own struct.
+ * Zero it (or use VLIST_NODE_INIT) before linking it the first time, unlinking zeroes it again.
+*/
+typedef struct vlist_node
+{
+    struct vlist_node* next;    // Next node, NULL at the back
+    struct vlist_node* prev;    // Previous node, NULL at the front
+} vlist_node;
+
+/**
+ * @brief Intrusive list: links vlist_node members of existing objects, never allocates
+ * and never copies element data. The objects are owned by the caller and have to
+ * stay in place while they are linked.
+*/
+typedef struct vlist_t
+{
+    vlist_node* first;          // First node, NULL if empty
+    vlist_node* last;           // Last node, NULL if empty
+    size_t size;                // Number of linked nodes
+} vlist_t;
+
+#define VLIST_NODE_INIT { NULL, NULL }
+#define VLIST_INIT { NULL, NULL, 0 }
+
+/**
+ * @brief Returns the T that embeds `node` as its `member`.
+*/
+#define vlist_entry(node, T, member) ((T*)((char*)(node) - offsetof(T, member)))
+
 /**
  * @brief Represents a constructor function to be called for each element when the ll is destroyed,
  * @note `this` is preallocated
@@ -94,6 +163,21 @@ vll_t* _vll_create(size_t stride, size_t initial_size);
 */
 #define vll_create(T, initial_size) (vll_t*)_vll_create(sizeof(T), initial_size)
 
+/**
+ * @brief Creates a vll whose header and links come from `allocator`.
+ *
+ * @param stride Size of each element in the ll.
+ * @param initial_size Initial number of elements the ll can hold.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the ll.
+ * @return Pointer to the newly created vll, or NULL if creation fails.
+*/
+vll_t* _vll_create_alloc(size_t stride, size_t initial_size, const vallocator_t* allocator);
+
+/**
+ * @brief Creates a vll of type T that allocates from `allocator`.
+*/
+#define vll_create_alloc(T, initial_size, allocator) (vll_t*)_vll_create_alloc(sizeof(T), initial_size, allocator)
+
 /**
  * @brief Creates a vll with the specified element stride, initial capacity, and scale factor.
  *
@@ -106,6 +190,60 @@ vll_t* _vll_create(size_t stride, size_t initial_size);
 */
 vll1_t* _vll1_create(size_t stride, size_t initial_size, vll1_ctor_t ctor, vll1_cctor_t cctor, vll1_dtor_t dtor);
 
+/**
+ * @brief Creates a vll1 whose header and links come from `allocator`.
+ *
+ * @param stride Size of each element in the ll.
+ * @param initial_size Initial number of elements the ll can hold.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the ll.
+ * @param ctor Constructor function to be called for when a ll is element is created, or NULL if default.
+ * @param cctor Copy constructor function to be called for when a ll is element is created, or NULL if default.
+ * @param dtor Destructor function to be called for each element when the ll is destroyed, or NULL if default.
+ * @return Pointer to the newly created vll, or NULL if creation fails.
+*/
+vll1_t* _vll1_create_alloc(size_t stride, size_t initial_size, const vallocator_t* allocator, vll1_ctor_t ctor, vll1_cctor_t cctor, vll1_dtor_t dtor);
+
+/**
+ * @brief Creates a vll1 of type T that allocates from `allocator`.
+*/
+#define vll1_create_alloc(T, initial_size, allocator, ctor, cctor, dtor) (vll1_t*)_vll1_create_alloc(sizeof(T), initial_size, allocator, ctor, cctor, dtor)
+
+/**
+ * @brief Creates an unrolled vll: every link stores up to `unroll` elements back to back,
+ * so walking the list touches one link per `unroll` elements. The vll API is unchanged.
+ * @note Elements are moved with memmove when links split or merge, so pointers to
+ * elements are only valid until the next insert or erase.
+ *
+ * @param stride Size of each element in the ll.
+ * @param unroll Elements per link, 0 to fit about VLL_UNROLL_BYTES per link.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the ll.
+ * @return Pointer to the newly created vll, or NULL if creation fails.
+*/
+vll_t* _vll_create_unrolled(size_t stride, size_t unroll, const vallocator_t* allocator);
+
+/**
+ * @brief Creates an unrolled vll of type T, see _vll_create_unrolled.
+*/
+#define vll_create_unrolled(T, unroll) (vll_t*)_vll_create_unrolled(sizeof(T), unroll, NULL)
+
+/**
+ * @brief Creates an unrolled vll1, see _vll_create_unrolled.
+ *
+ * @param stride Size of each element in the ll.
+ * @param unroll Elements per link, 0 to fit about VLL_UNROLL_BYTES per link.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the ll.
+ * @param ctor Constructor function to be called for when a ll is element is created, or NULL if default.
+ * @param cctor Copy constructor function to be called for when a ll is element is created, or NULL if default.
+ * @param dtor Destructor function to be called for each element when the ll is destroyed, or NULL if default.
+ * @return Pointer to the newly created vll, or NULL if creation fails.
+*/
+vll1_t* _vll1_create_unrolled(size_t stride, size_t unroll, const vallocator_t* allocator, vll1_ctor_t ctor, vll1_cctor_t cctor, vll1_dtor_t dtor);
+
+/**
+ * @brief Creates an unrolled vll1 of type T, see _vll_create_unrolled.
+*/
+#define vll1_create_unrolled(T, unroll, ctor, cctor, dtor) (vll1_t*)_vll1_create_unrolled(sizeof(T), unroll, NULL, ctor, cctor, dtor)
+
 /**
  * @brief Creates a vll with the specified element stride, initial capacity, and scale factor.
  *
@@ -280,6 +418,69 @@ void vll_reverse(vll_t* ll);
 */
 void vll_destroy(vll_t** ll);
 
+/**
+ * @brief Returns an iterator at the element at `index` (walks from the nearer end).
+ *
+ * @param ll Pointer to the vll.
+ * @param index Index value. Can be negative of positive, the length gives an iterator past the end.
+ * @return The iterator, not valid if the list is empty or `index` is the length.
+*/
+vll_iter_t vll_iter_at(vll_t* ll, ssize_t index);
+
+/**
+ * @brief Returns an iterator at the first element.
+*/
+#define vll_begin(ll) vll_iter_at(ll, VLL_FRONT)
+
+/**
+ * @brief Returns an iterator at the last element.
+*/
+#define vll_rbegin(ll) vll_iter_at(ll, VLL_BACK)
+
+/**
+ * @brief Checks whether the iterator is at an element.
+ *
+ * @return 1 if it is, 0 past either end.
+*/
+int vll_iter_valid(const vll_iter_t* iter);
+
+/**
+ * @brief Returns a pointer to the element of the iterator, or NULL past either end.
+*/
+void* vll_iter_get(const vll_iter_t* iter);
+
+/**
+ * @brief Moves the iterator to the next element.
+ *
+ * @return 1 if the iterator is still valid, 0 once it went past the end.
+*/
+int vll_iter_next(vll_iter_t* iter);
+
+/**
+ * @brief Moves the iterator to the previous element.
+ *
+ * @return 1 if the iterator is still valid, 0 once it went past the front.
+*/
+int vll_iter_prev(vll_iter_t* iter);
+
+/**
+ * @brief Copies a object into the ll right after the element of `iter` in O(1).
+ * The iterator stays at its element, an iterator past the end pushes to the back.
+ *
+ * @param iter Pointer to the iterator.
+ * @param original Pointer to the original to copy.
+ * @return 0 on success, or -1 on failure.
+*/
+int vll_insert_after(vll_iter_t* iter, const void* original);
+
+/**
+ * @brief Removes the element of `iter` in O(1) and moves the iterator to the element after it.
+ *
+ * @param iter Pointer to the iterator.
+ * @return 0 on success, or -1 if the iterator is not valid.
+*/
+int vll_erase_at(vll_iter_t* iter);
+
 /**
  * Macro to iterate over a vll
  * @param T Type of the item to iterate over
@@ -287,11 +488,93 @@ void vll_destroy(vll_t** ll);
  * @param index The name of the indexer(normally name i)
  * @param ll The vll to iterate over
  * @param action The action to perform on each iteration(if any) -> Optional
+ * @note Walks the links with a vll_iter_t, so a full pass is O(n)
 */
 #define vll_foreach(T, item, index, ll, action) do { \
-    size_t __len = vll_get_field(ll, VLL_FIELD_LENGTH); \
-    for (size_t index = 0; index < __len; index++) { \
-        T* item = (T*)vll_at(ll, index); \
+    size_t index = 0; \
+    for (vll_iter_t __it = vll_begin(ll); vll_iter_valid(&__it); vll_iter_next(&__it), index++) { \
+        T* item = (T*)vll_iter_get(&__it); \
+        action \
+    } \
+} while(0)
+
+// Intrusive list
+
+/**
+ * @brief Empties `list` without touching any node (same as assigning VLIST_INIT).
+*/
+void vlist_init(vlist_t* list);
+
+/**
+ * @brief Checks if the intrusive list is empty.
+*/
+#define vlist_empty(list) ((list)->first == NULL)
+
+/**
+ * @brief Links `node` at the front of `list`.
+ *
+ * @return 0 on success, or -1 on failure.
+*/
+int vlist_push_front(vlist_t* list, vlist_node* node);
+
+/**
+ * @brief Links `node` at the back of `list`.
+ *
+ * @return 0 on success, or -1 on failure.
+*/
+int vlist_push_back(vlist_t* list, vlist_node* node);
+
+/**
+ * @brief Links `node` right after `pos`.
+ *
+ * @param list Pointer to the list.
+ * @param pos Node of `list` to link after, NULL to link at the front.
+ * @param node Unlinked node.
+ * @return 0 on success, or -1 on failure.
+*/
+int vlist_insert_after(vlist_t* list, vlist_node* pos, vlist_node* node);
+
+/**
+ * @brief Links `node` right before `pos`.
+ *
+ * @param list Pointer to the list.
+ * @param pos Node of `list` to link before, NULL to link at the back.
+ * @param node Unlinked node.
+ * @return 0 on success, or -1 on failure.
+*/
+int vlist_insert_before(vlist_t* list, vlist_node* pos, vlist_node* node);
+
+/**
+ * @brief Unlinks `node` from `list` in O(1) and zeroes it. The object itself is left alone.
+ * `node` has to be linked into `list`.
+ *
+ * @return 0 on success, or -1 on failure (including a node that is not linked).
+*/
+int vlist_unlink(vlist_t* list, vlist_node* node);
+
+/**
+ * @brief Unlinks and returns the first node, NULL if the list is empty.
+*/
+vlist_node* vlist_pop_front(vlist_t* list);
+
+/**
+ * @brief Unlinks and returns the last node, NULL if the list is empty.
+*/
+vlist_node* vlist_pop_back(vlist_t* list);
+
+/**
+ * Macro to iterate over an intrusive list
+ * @param T Type of the objects that embed the nodes
+ * @param item A variable of type T* that will be assigned each object
+ * @param member Name of the vlist_node member of T
+ * @param list The vlist_t to iterate over
+ * @param action The action to perform on each iteration(if any) -> Optional
+ * @note The current node may be unlinked inside `action`
+*/
+#define vlist_foreach(T, item, member, list, action) do { \
+    for (vlist_node* __node = (list)->first, *__next; __node; __node = __next) { \
+        __next = __node->next; \
+        T* item = vlist_entry(__node, T, member); \
         action \
     } \
 } while(0)
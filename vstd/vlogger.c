@@ -1,9 +1,16 @@
 #include <vlogger.h>
+#include <vdef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <stdarg.h>
 
+static void log_writer_run(void);
+static void log_thread_exit(void* value);
+
+#define VLOG_CACHE_LINE 64
+
 #if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
     #include <Windows.h>   // Use Windows threading API
 
@@ -25,10 +32,99 @@
         CloseHandle(log_mutex);
     }
 
+    typedef HANDLE log_thread_t;
+
+    static DWORD WINAPI log_thread_entry(LPVOID arg) {
+        (void)arg;
+        log_writer_run();
+        return 0;
+    }
+
+    static int log_thread_start(log_thread_t* thread) {
+        *thread = CreateThread(NULL, 0, log_thread_entry, NULL, 0, NULL);
+        return (*thread)? 0 : -1;
+    }
+
+    static void log_thread_join(log_thread_t thread) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    }
+
+    static DWORD log_exit_key = FLS_OUT_OF_INDEXES;
+
+    static VOID WINAPI log_exit_entry(PVOID value) {
+        if (value) log_thread_exit(value);
+    }
+
+    // Makes log_thread_exit(value) run when the calling thread exits (caller holds log_mutex)
+    static void log_thread_on_exit(void* value) {
+        if (log_exit_key == FLS_OUT_OF_INDEXES) {
+            log_exit_key = FlsAlloc(log_exit_entry);
+        }
+        if (log_exit_key != FLS_OUT_OF_INDEXES) {
+            FlsSetValue(log_exit_key, value);
+        }
+    }
+
+    static void log_sleep_ms(unsigned ms) {
+        Sleep(ms);
+    }
+
+    static void log_yield(void) {
+        SwitchToThread();
+    }
+
+    static uint64_t log_now_ns(void) {
+        static LARGE_INTEGER freq = {0};
+        LARGE_INTEGER now;
+        if (!freq.QuadPart) {
+            QueryPerformanceFrequency(&freq);
+        }
+        QueryPerformanceCounter(&now);
+        return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000u
+             + (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000u / (uint64_t)freq.QuadPart;
+    }
+
+    // size_t is pointer sized on every Windows target, so the pointer intrinsics cover both x86 and x64
+    static size_t log_atomic_load(volatile size_t* ptr) {
+        return (size_t)InterlockedCompareExchangePointer((PVOID volatile*)ptr, NULL, NULL);
+    }
+
+    static void log_atomic_store(volatile size_t* ptr, size_t val) {
+        InterlockedExchangePointer((PVOID volatile*)ptr, (PVOID)val);
+    }
+
+    static int log_atomic_cas(volatile size_t* ptr, size_t expected, size_t desired) {
+        return InterlockedCompareExchangePointer((PVOID volatile*)ptr, (PVOID)desired, (PVOID)expected) == (PVOID)expected;
+    }
+
+    // Returns the previous value
+    static size_t log_atomic_add(volatile size_t* ptr, size_t val) {
+    #if defined(_WIN64)
+        return (size_t)InterlockedExchangeAdd64((LONGLONG volatile*)ptr, (LONGLONG)val);
+    #else
+        return (size_t)InterlockedExchangeAdd((LONG volatile*)ptr, (LONG)val);
+    #endif
+    }
+
+    static uint64_t log_atomic_load64(volatile uint64_t* ptr) {
+        return (uint64_t)InterlockedCompareExchange64((LONGLONG volatile*)ptr, 0, 0);
+    }
+
+    static void log_atomic_store64(volatile uint64_t* ptr, uint64_t val) {
+        InterlockedExchange64((LONGLONG volatile*)ptr, (LONGLONG)val);
+    }
+
+    static void log_fence(void) {
+        MemoryBarrier();
+    }
+
 #elif defined(__unix__) || defined(__unix) || defined(__APPLE__) || defined(__linux__)
     #include <pthread.h>    // Use POSIX threads on Unix-based systems
+    #include <sched.h>
+    #include <time.h>
 
-    pthread_mutex_t log_mutex;
+    pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
     void init_mutex() {
         pthread_mutex_init(&log_mutex, NULL);
@@ -46,10 +142,85 @@
         pthread_mutex_destroy(&log_mutex);
     }
 
+    typedef pthread_t log_thread_t;
+
+    static void* log_thread_entry(void* arg) {
+        (void)arg;
+        log_writer_run();
+        return NULL;
+    }
+
+    static int log_thread_start(log_thread_t* thread) {
+        return (pthread_create(thread, NULL, log_thread_entry, NULL) == 0)? 0 : -1;
+    }
+
+    static void log_thread_join(log_thread_t thread) {
+        pthread_join(thread, NULL);
+    }
+
+    static pthread_key_t log_exit_key;
+    static int log_exit_ready = 0;
+
+    // Makes log_thread_exit(value) run when the calling thread exits (caller holds log_mutex)
+    static void log_thread_on_exit(void* value) {
+        if (!log_exit_ready) {
+            log_exit_ready = (pthread_key_create(&log_exit_key, log_thread_exit) == 0);
+        }
+        if (log_exit_ready) {
+            pthread_setspecific(log_exit_key, value);
+        }
+    }
+
+    static void log_sleep_ms(unsigned ms) {
+        struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+
+    static void log_yield(void) {
+        sched_yield();
+    }
+
+    static uint64_t log_now_ns(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    }
+
+    static size_t log_atomic_load(volatile size_t* ptr) {
+        return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+    }
+
+    static void log_atomic_store(volatile size_t* ptr, size_t val) {
+        __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+    }
+
+    static int log_atomic_cas(volatile size_t* ptr, size_t expected, size_t desired) {
+        return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+
+    // Returns the previous value
+    static size_t log_atomic_add(volatile size_t* ptr, size_t val) {
+        return __atomic_fetch_add(ptr, val, __ATOMIC_ACQ_REL);
+    }
+
+    static uint64_t log_atomic_load64(volatile uint64_t* ptr) {
+        return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+    }
+
+    static void log_atomic_store64(volatile uint64_t* ptr, uint64_t val) {
+        __atomic_store_n(ptr, val, __ATOMIC_SEQ_CST);
+    }
+
+    static void log_fence(void) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+
 #elif defined(__STDC_NO_THREADS__)
     #error "C11 threads are not supported. Please use a different threading API."
 #else
     #include <threads.h>
+    #include <stdatomic.h>
+    #include <time.h>
 
     mtx_t log_mutex;
 
@@ -69,15 +240,99 @@
         mtx_destroy(&log_mutex);
     }
 
+    typedef thrd_t log_thread_t;
+
+    static int log_thread_entry(void* arg) {
+        (void)arg;
+        log_writer_run();
+        return 0;
+    }
+
+    static int log_thread_start(log_thread_t* thread) {
+        return (thrd_create(thread, log_thread_entry, NULL) == thrd_success)? 0 : -1;
+    }
+
+    static void log_thread_join(log_thread_t thread) {
+        thrd_join(thread, NULL);
+    }
+
+    static tss_t log_exit_key;
+    static int log_exit_ready = 0;
+
+    // Makes log_thread_exit(value) run when the calling thread exits (caller holds log_mutex)
+    static void log_thread_on_exit(void* value) {
+        if (!log_exit_ready) {
+            log_exit_ready = (tss_create(&log_exit_key, log_thread_exit) == thrd_success);
+        }
+        if (log_exit_ready) {
+            tss_set(log_exit_key, value);
+        }
+    }
+
+    static void log_sleep_ms(unsigned ms) {
+        struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+        thrd_sleep(&ts, NULL);
+    }
+
+    static void log_yield(void) {
+        thrd_yield();
+    }
+
+    static uint64_t log_now_ns(void) {
+        struct timespec ts;
+    #if defined(TIME_MONOTONIC)
+        timespec_get(&ts, TIME_MONOTONIC);
+    #elif defined(CLOCK_MONOTONIC)
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+    #else
+        // Wall clock only: a clock step can reorder the per-thread merge, see vloggerStart
+        timespec_get(&ts, TIME_UTC);
+    #endif
+        return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    }
+
+    static size_t log_atomic_load(volatile size_t* ptr) {
+        return atomic_load_explicit((volatile _Atomic size_t*)ptr, memory_order_acquire);
+    }
+
+    static void log_atomic_store(volatile size_t* ptr, size_t val) {
+        atomic_store_explicit((volatile _Atomic size_t*)ptr, val, memory_order_release);
+    }
+
+    static int log_atomic_cas(volatile size_t* ptr, size_t expected, size_t desired) {
+        return atomic_compare_exchange_strong((volatile _Atomic size_t*)ptr, &expected, desired);
+    }
+
+    // Returns the previous value
+    static size_t log_atomic_add(volatile size_t* ptr, size_t val) {
+        return atomic_fetch_add_explicit((volatile _Atomic size_t*)ptr, val, memory_order_acq_rel);
+    }
+
+    static uint64_t log_atomic_load64(volatile uint64_t* ptr) {
+        return atomic_load((volatile _Atomic uint64_t*)ptr);
+    }
+
+    static void log_atomic_store64(volatile uint64_t* ptr, uint64_t val) {
+        atomic_store((volatile _Atomic uint64_t*)ptr, val);
+    }
+
+    static void log_fence(void) {
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+
 #endif
 
+static uint64_t log_now_ms(void) {
+    return log_now_ns() / 1000000u;
+}
+
 
-static void console_write(FILE* _Stream, const char* message, uint8_t colour);
+static void console_write(const char* message, size_t length, uint8_t colour);
 
 #if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
 #include <Windows.h>
 
-static void console_write(FILE* _Stream, const char* message, uint8_t colour) 
+static void console_write(const char* message, size_t length, uint8_t colour)
 {
     if (colour > 5) {
         return;
@@ -98,17 +353,10 @@ static void console_write(FILE* _Stream, const char* message, uint8_t colour)
 
     OutputDebugStringA(message);
 
-    DWORD length = (DWORD)strlen(message);
     DWORD number_written = 0;
-    WriteConsoleA(console_handle, message, length, &number_written, NULL);
+    WriteConsoleA(console_handle, message, (DWORD)length, &number_written, NULL);
 
     SetConsoleTextAttribute(console_handle, csbi.wAttributes);
-
-    if (_Stream) {
-        fwrite(message, sizeof(char), VLOG_MSG_MAX_LEN, _Stream);
-        fflush(_Stream);
-        fclose(_Stream);
-    }
 }
 
 
@@ -116,7 +364,7 @@ static void console_write(FILE* _Stream, const char* message, uint8_t colour)
 #elif defined(__unix__) || defined(_unix) || defined(__APPLE__) || defined(__linux__)
 #include <xcb/xcb.h>
 
-static void console_write(FILE* _Stream, const char* message, uint8_t colour) 
+static void console_write(const char* message, size_t length, uint8_t colour)
 {
     if (colour > 5) {
         return;
@@ -124,29 +372,130 @@ static void console_write(FILE* _Stream, const char* message, uint8_t colour)
 	//[FATAL], [ERROR], [WARN], [INFO], [DEBUG], [TRACE]
 	static const char* levels[] = {"0;41", "1;31", "1;33", "1;32", "1;34", "1;30"};
 
-	fprintf((colour <= VLOG_LEVEL_ERROR)? stderr : stdout:,"\033[%sm%s\033[0m", levels[colour], message);
-
-
-    if (_Stream) {
-        fwrite(message, sizeof(char), VLOG_MSG_MAX_LEN, _Stream);
-        fflush(_Stream);
-    }
+	fprintf((colour <= VLOG_LEVEL_ERROR)? stderr : stdout,"\033[%sm%.*s\033[0m", levels[colour], (int)length, message);
 }
 
 #else
 
-static void console_write(FILE* _Stream, const char* message, uint8_t colour) 
+static void console_write(const char* message, size_t length, uint8_t colour)
 {
     if (colour > 5) {
         return;
     }
 
-    fprintf((colour <= 1) ? stderr : stdout, "%s", message);
+    fprintf((colour <= 1) ? stderr : stdout, "%.*s", (int)length, message);
+}
+
+#endif
+
+/*
+    Mapped files:
+    Creates a file of `size` bytes and maps it writable. Closing unmaps it and cuts
+    the file down to the `keep` bytes that were actually written.
+*/
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+
+typedef struct log_map_handle_t
+{
+    HANDLE file;
+    HANDLE mapping;
+} log_map_handle_t;
+
+static char* log_map_open(const char* path, size_t size, log_map_handle_t* handle)
+{
+    LARGE_INTEGER length;
+    length.QuadPart = (LONGLONG)size;
+
+    handle->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle->file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    handle->mapping = CreateFileMappingA(handle->file, NULL, PAGE_READWRITE, (DWORD)(length.QuadPart >> 32), (DWORD)length.QuadPart, NULL);
+    char* base = (handle->mapping)? (char*)MapViewOfFile(handle->mapping, FILE_MAP_WRITE, 0, 0, size) : NULL;
+    if (!base) {
+        if (handle->mapping) CloseHandle(handle->mapping);
+        CloseHandle(handle->file);
+        return NULL;
+    }
+    return base;
+}
+
+static void log_map_close(char* base, size_t size, size_t keep, log_map_handle_t* handle)
+{
+    (void)size;
+    LARGE_INTEGER length;
+    length.QuadPart = (LONGLONG)keep;
+
+    UnmapViewOfFile(base);
+    CloseHandle(handle->mapping);
+    SetFilePointerEx(handle->file, length, NULL, FILE_BEGIN);
+    SetEndOfFile(handle->file);
+    CloseHandle(handle->file);
+}
+
+static void log_map_sync(char* base, size_t length)
+{
+    FlushViewOfFile(base, length);
+}
+
+#elif defined(__unix__) || defined(_unix) || defined(__APPLE__) || defined(__linux__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef int log_map_handle_t;
+
+static char* log_map_open(const char* path, size_t size, log_map_handle_t* handle)
+{
+    *handle = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (*handle == -1) {
+        return NULL;
+    }
+
+    void* base = MAP_FAILED;
+    if (ftruncate(*handle, (off_t)size) == 0) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *handle, 0);
+    }
+    if (base == MAP_FAILED) {
+        close(*handle);
+        return NULL;
+    }
+    return (char*)base;
+}
 
-    if (_Stream) {
-        fwrite(message, sizeof(char), VLOG_MSG_MAX_LEN, _Stream);
-        fflush(_Stream);
+static void log_map_close(char* base, size_t size, size_t keep, log_map_handle_t* handle)
+{
+    munmap(base, size);
+    if (ftruncate(*handle, (off_t)keep) != 0) {
+        // The file keeps its zero filled tail
     }
+    close(*handle);
+}
+
+static void log_map_sync(char* base, size_t length)
+{
+    msync(base, length, MS_ASYNC);
+}
+
+#else
+
+typedef int log_map_handle_t;
+
+static char* log_map_open(const char* path, size_t size, log_map_handle_t* handle)
+{
+    (void)path; (void)size; (void)handle;
+    return NULL;
+}
+
+static void log_map_close(char* base, size_t size, size_t keep, log_map_handle_t* handle)
+{
+    (void)base; (void)size; (void)keep; (void)handle;
+}
+
+static void log_map_sync(char* base, size_t length)
+{
+    (void)base; (void)length;
 }
 
 #endif
@@ -155,40 +504,1579 @@ static void console_write(FILE* _Stream, const char* message, uint8_t colour)
 #define __builtin_va_list va_list
 #endif
 
-void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
+static const char* lvls[6] = {
+    "[FATAL]: ",
+    "[ERROR]: ",
+    "[WARN]:  ",
+    "[INFO]:  ",
+    "[DEBUG]: ",
+    "[TRACE]: "
+};
+
+/*
+    Binary codec:
+    A binary event stores the arguments of a printf style call in the order the
+    format string consumes them. Integers, characters, pointers and `*` widths are
+    widened to 8 bytes, floating point values are stored as doubles and strings as
+    a 16 bit length followed by their bytes. The format string itself is all the
+    type information the decoder needs.
+*/
+typedef struct log_spec_t
 {
-    log_lock();
+    const char* start;      // '%' of the conversion
+    const char* len_start;  // First length modifier character
+    const char* end;        // One past the conversion character
+    int stars;              // Number of '*' width/precision arguments
+    long precision;         // Digits after '.', -1 if none, -2 if given by the last '*'
+    char length;            // 0, 'H' (hh), 'h', 'l', 'q' (ll), 'j', 'z', 't' or 'L'
+    char conv;              // Conversion character
+} log_spec_t;
 
-    const char* lvls[6] = {
-        "[FATAL]: ",
-        "[ERROR]: ",
-        "[WARN]:  ",
-        "[INFO]:  ",
-        "[DEBUG]: ",
-        "[TRACE]: "
-    };
+// Finds the next conversion in `fmt`, returns NULL once there are none left
+static const char* log_spec_next(const char* fmt, log_spec_t* spec)
+{
+    const char* p = strchr(fmt, '%');
+    if (!p) return NULL;
 
-    char va_message[VLOG_MSG_MAX_LEN] = {0};
-    char out_message[VLOG_MSG_MAX_LEN] = {0};
+    spec->start = p++;
+    spec->stars = 0;
+    spec->precision = -1;
+    spec->length = 0;
 
-    va_list arg_ptr;
-    va_start(arg_ptr, message);
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') { spec->stars++; p++; }
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        spec->precision = 0;
+        if (*p == '*') { spec->stars++; spec->precision = -2; p++; }
+        while (*p >= '0' && *p <= '9') spec->precision = spec->precision * 10 + (*p++ - '0');
+    }
 
-    vsnprintf(va_message, VLOG_MSG_MAX_LEN, message, arg_ptr);
-    va_end(arg_ptr);
+    spec->len_start = p;
+    switch (*p) {
+        case 'h': spec->length = (p[1] == 'h')? 'H' : 'h'; p += (p[1] == 'h')? 2 : 1; break;
+        case 'l': spec->length = (p[1] == 'l')? 'q' : 'l'; p += (p[1] == 'l')? 2 : 1; break;
+        case 'j': case 'z': case 't': case 'L': spec->length = *p++; break;
+        default: break;
+    }
+
+    spec->conv = *p;
+    spec->end = (*p)? p + 1 : p;
+    return spec->end;
+}
+
+static size_t log_bin_put(unsigned char* out, size_t cap, size_t at, const void* val, size_t size)
+{
+    if (at + size > cap) return cap + 1;
+    memcpy(out + at, val, size);
+    return at + size;
+}
+
+// Stores at most `precision` bytes of `str` (all of it if negative), like printf it
+// never reads past a NUL or past the precision
+static size_t log_bin_put_str(unsigned char* out, size_t cap, size_t at, const char* str, long precision)
+{
+    if (!str) str = "(null)";
+    if (at + sizeof(uint16_t) > cap) return cap + 1;
+
+    size_t limit = cap - at - sizeof(uint16_t);
+    if (limit > UINT16_MAX) limit = UINT16_MAX;
+    if (precision >= 0 && (size_t)precision < limit) limit = (size_t)precision;
+
+    const char* nul = (const char*)memchr(str, '\0', limit);
+    size_t len = (nul)? (size_t)(nul - str) : limit;
+
+    uint16_t len16 = (uint16_t)len;
+    at = log_bin_put(out, cap, at, &len16, sizeof(len16));
+    return log_bin_put(out, cap, at, str, len);
+}
+
+// Encodes the arguments of `fmt` into `out`, returns the number of bytes used
+static size_t log_bin_encode(unsigned char* out, size_t cap, const char* fmt, va_list args)
+{
+    size_t at = 0;
+    log_spec_t spec;
+
+    while ((fmt = log_spec_next(fmt, &spec)) != NULL && at <= cap) {
+        for (int i = 0; i < spec.stars; i++) {
+            int64_t star = va_arg(args, int);
+            at = log_bin_put(out, cap, at, &star, sizeof(star));
+            if (i == spec.stars - 1 && spec.precision == -2) {
+                // A negative precision argument counts as no precision
+                spec.precision = (star < 0)? -1 : (long)star;
+            }
+        }
+
+        int64_t ival = 0;
+        uint64_t uval = 0;
+        double dval = 0.0;
+
+        switch (spec.conv) {
+            case 'd': case 'i':
+                switch (spec.length) {
+                    case 'l': ival = va_arg(args, long); break;
+                    case 'q': ival = va_arg(args, long long); break;
+                    case 'j': ival = (int64_t)va_arg(args, intmax_t); break;
+                    case 'z': ival = (int64_t)va_arg(args, size_t); break;
+                    case 't': ival = (int64_t)va_arg(args, ptrdiff_t); break;
+                    default:  ival = va_arg(args, int); break;
+                }
+                at = log_bin_put(out, cap, at, &ival, sizeof(ival));
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                switch (spec.length) {
+                    case 'l': uval = va_arg(args, unsigned long); break;
+                    case 'q': uval = va_arg(args, unsigned long long); break;
+                    case 'j': uval = (uint64_t)va_arg(args, uintmax_t); break;
+                    case 'z': uval = (uint64_t)va_arg(args, size_t); break;
+                    case 't': uval = (uint64_t)va_arg(args, ptrdiff_t); break;
+                    default:  uval = va_arg(args, unsigned int); break;
+                }
+                at = log_bin_put(out, cap, at, &uval, sizeof(uval));
+                break;
+            case 'c':
+                ival = va_arg(args, int);
+                at = log_bin_put(out, cap, at, &ival, sizeof(ival));
+                break;
+            case 'p':
+                uval = (uint64_t)(uintptr_t)va_arg(args, void*);
+                at = log_bin_put(out, cap, at, &uval, sizeof(uval));
+                break;
+            case 's':
+                if (spec.length == 'l') {
+                    // Wide strings are narrowed, anything outside ASCII becomes '?'
+                    const wchar_t* wstr = va_arg(args, const wchar_t*);
+                    char narrow[VLOG_MSG_MAX_LEN];
+                    size_t n = 0;
+                    size_t max = sizeof(narrow) - 1;
+                    if (spec.precision >= 0 && (size_t)spec.precision < max) max = (size_t)spec.precision;
+                    for (; wstr && n < max && wstr[n]; n++) {
+                        narrow[n] = (wstr[n] < 128)? (char)wstr[n] : '?';
+                    }
+                    narrow[n] = '\0';
+                    at = log_bin_put_str(out, cap, at, wstr? narrow : NULL, -1);
+                } else {
+                    at = log_bin_put_str(out, cap, at, va_arg(args, const char*), spec.precision);
+                }
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                dval = (spec.length == 'L')? (double)va_arg(args, long double) : va_arg(args, double);
+                at = log_bin_put(out, cap, at, &dval, sizeof(dval));
+                break;
+            case 'n':
+                (void)va_arg(args, void*);
+                break;
+            case '%':
+                break;
+            default:
+                // Unknown conversion, the remaining argument types can't be known
+                return (at > cap)? cap : at;
+        }
+    }
+
+    return (at > cap)? cap : at;
+}
+
+static int log_bin_get(const unsigned char* args, size_t size, size_t* at, void* val, size_t val_size)
+{
+    if (*at + val_size > size) return -1;
+    memcpy(val, args + *at, val_size);
+    *at += val_size;
+    return 0;
+}
+
+// Formats `fmt` with the encoded arguments into `out`, returns the text length
+static size_t log_bin_format(char* out, size_t cap, const char* fmt, const unsigned char* args, size_t size)
+{
+    size_t len = 0;
+    size_t at = 0;
+    log_spec_t spec;
+    const char* next;
+
+    if (!cap) return 0;
+    out[0] = '\0';
+
+    while ((next = log_spec_next(fmt, &spec)) != NULL && len < cap - 1) {
+        // Literal text up to the conversion
+        size_t literal = (size_t)(spec.start - fmt);
+        if (literal > cap - 1 - len) literal = cap - 1 - len;
+        memcpy(out + len, fmt, literal);
+        len += literal;
+        fmt = next;
 
-    snprintf(out_message, VLOG_MSG_MAX_LEN, "%s%s\n", lvls[level], va_message);
-    
-    FILE * __stream = NULL;
-    
-    if(_Stream){
-        __stream = fopen(_Stream, "a");
-        if(!__stream) {
-            console_write(NULL, "[WARN]:  Faild to open or create file", VLOG_LEVEL_WARN);
+        int64_t stars[2] = {0, 0};
+        int failed = 0;
+        for (int i = 0; i < spec.stars; i++) {
+            failed |= log_bin_get(args, size, &at, &stars[i], sizeof(stars[i]));
         }
+
+        // Rebuild the conversion with the length modifier the stored value needs
+        char spec_fmt[64];
+        size_t head = (size_t)(spec.len_start - spec.start);
+        if (head > sizeof(spec_fmt) - 4) break;
+        memcpy(spec_fmt, spec.start, head);
+
+        char* o = out + len;
+        size_t r = cap - len;
+        int w0 = (int)stars[0], w1 = (int)stars[1];
+        int n = 0;
+
+        #define LOG_SPEC_PRINT(val) \
+            ((spec.stars == 2)? snprintf(o, r, spec_fmt, w0, w1, val) : \
+             (spec.stars == 1)? snprintf(o, r, spec_fmt, w0, val) : \
+                                snprintf(o, r, spec_fmt, val))
+
+        switch (spec.conv) {
+            case 'd': case 'i': {
+                long long val = 0;
+                memcpy(spec_fmt + head, "ll", 2);
+                spec_fmt[head + 2] = spec.conv; spec_fmt[head + 3] = '\0';
+                failed |= log_bin_get(args, size, &at, &val, sizeof(int64_t));
+                if (!failed) n = LOG_SPEC_PRINT(val);
+                break;
+            }
+            case 'u': case 'o': case 'x': case 'X': {
+                unsigned long long val = 0;
+                memcpy(spec_fmt + head, "ll", 2);
+                spec_fmt[head + 2] = spec.conv; spec_fmt[head + 3] = '\0';
+                failed |= log_bin_get(args, size, &at, &val, sizeof(uint64_t));
+                if (!failed) n = LOG_SPEC_PRINT(val);
+                break;
+            }
+            case 'c': {
+                int64_t val = 0;
+                spec_fmt[head] = 'c'; spec_fmt[head + 1] = '\0';
+                failed |= log_bin_get(args, size, &at, &val, sizeof(val));
+                if (!failed) n = LOG_SPEC_PRINT((int)val);
+                break;
+            }
+            case 'p': {
+                uint64_t val = 0;
+                spec_fmt[head] = 'p'; spec_fmt[head + 1] = '\0';
+                failed |= log_bin_get(args, size, &at, &val, sizeof(val));
+                if (!failed) n = LOG_SPEC_PRINT((void*)(uintptr_t)val);
+                break;
+            }
+            case 's': {
+                uint16_t slen = 0;
+                char str[VLOG_MSG_MAX_LEN];
+                spec_fmt[head] = 's'; spec_fmt[head + 1] = '\0';
+                failed |= log_bin_get(args, size, &at, &slen, sizeof(slen));
+                if (!failed && slen >= sizeof(str)) failed = 1;
+                if (!failed) failed |= log_bin_get(args, size, &at, str, slen);
+                if (!failed) {
+                    str[slen] = '\0';
+                    n = LOG_SPEC_PRINT(str);
+                }
+                break;
+            }
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                double val = 0.0;
+                spec_fmt[head] = spec.conv; spec_fmt[head + 1] = '\0';
+                failed |= log_bin_get(args, size, &at, &val, sizeof(val));
+                if (!failed) n = LOG_SPEC_PRINT(val);
+                break;
+            }
+            case '%':
+                out[len] = '%';
+                n = 1;
+                break;
+            case 'n':
+                break;
+            default:
+                failed = 1;
+                break;
+        }
+
+        #undef LOG_SPEC_PRINT
+
+        if (failed) break;
+        if (n > 0) len += ((size_t)n < r)? (size_t)n : r - 1;
+    }
+
+    if (!next && len < cap - 1) {
+        // Trailing literal text
+        size_t literal = strlen(fmt);
+        if (literal > cap - 1 - len) literal = cap - 1 - len;
+        memcpy(out + len, fmt, literal);
+        len += literal;
     }
-    console_write(__stream, out_message, level);
 
+    out[len] = '\0';
+    return len;
+}
+
+// Renders an encoded event as `[LEVEL]: message\n` into `out`, returns its length
+static size_t log_bin_render(char* out, uint8_t level, const char* fmt, const unsigned char* args, size_t size)
+{
+    size_t prefix = strlen(lvls[level]);
+    memcpy(out, lvls[level], prefix);
+
+    size_t length = prefix + log_bin_format(out + prefix, VLOG_MSG_MAX_LEN - prefix - 1, fmt, args, size);
+    out[length++] = '\n';
+    out[length] = '\0';
+    return length;
+}
+
+/*
+    Format registry:
+    Every binary call site registers its format string once and keeps the id
+    in a static. Ids index `vlog_formats` (id 0 is never handed out).
+    The registry is only touched while holding log_mutex.
+*/
+static const char** vlog_formats = NULL;
+static uint32_t vlog_format_count = 0;
+static uint32_t vlog_format_cap = 0;
+
+static const char* log_format_get(uint32_t id)
+{
+    return (id && id <= vlog_format_count)? vlog_formats[id - 1] : NULL;
+}
+
+static uint32_t log_format_register(uint32_t* fmt_id, const char* fmt)
+{
+    log_lock();
+    if (*fmt_id == 0) {
+        if (vlog_format_count == vlog_format_cap) {
+            uint32_t new_cap = (vlog_format_cap)? vlog_format_cap * 2 : 64;
+            const char** new_formats = (const char**)realloc((void*)vlog_formats, new_cap * sizeof(const char*));
+            if (!new_formats) {
+                log_unlock();
+                return 0;
+            }
+            vlog_formats = new_formats;
+            vlog_format_cap = new_cap;
+        }
+        vlog_formats[vlog_format_count++] = fmt;
+        *fmt_id = vlog_format_count;
+    }
+    uint32_t id = *fmt_id;
     log_unlock();
+    return id;
+}
+
+/*
+    Stream registry:
+    Every stream path gets a sink the first time it is logged to. The sink keeps
+    the file open with a large stdio buffer and flushes it by size or by time,
+    so a log call costs a buffered fwrite instead of fopen + fwrite + fflush.
+    The registry is only touched while holding log_mutex.
+*/
+typedef struct vlog_sink_t
+{
+    char path[VLOG_STREAM_MAX_LEN];     // Stream path this sink belongs to
+    FILE* file;                         // Open file
+    size_t pending;                     // Bytes written since the last flush
+    uint64_t last_flush;                // Time of the last flush in ms
+    int binary;                         // 1 if the file is a binary log
+    uint8_t* formats;                   // Bitmap of format ids already defined in the file
+    size_t formats_size;                // Size of `formats` in bytes
+} vlog_sink_t;
+
+static vlog_sink_t vlog_sinks[VLOG_MAX_STREAMS];
+static size_t vlog_sink_count = 0;
+
+static void log_sink_flush(vlog_sink_t* sink, uint64_t now)
+{
+    if (sink->file && sink->pending) {
+        fflush(sink->file);
+    }
+    sink->pending = 0;
+    sink->last_flush = now;
+}
+
+// Opens `_Stream` for appending. Empty files become binary logs if `binary` is set,
+// existing files keep whatever they already are.
+static FILE* log_file_open(const char* _Stream, int binary, int* out_binary)
+{
+    char magic[sizeof(VLOG_BINARY_MAGIC) - 1] = {0};
+    FILE* file = fopen(_Stream, "rb");
+    size_t existing = 0;
+
+    if (file) {
+        existing = fread(magic, 1, sizeof(magic), file);
+        fclose(file);
+    }
+
+    if (existing) {
+        binary = (existing == sizeof(magic) && memcmp(magic, VLOG_BINARY_MAGIC, sizeof(magic)) == 0);
+    }
+
+    file = fopen(_Stream, (binary)? "ab" : "a");
+    if (file && binary && !existing) {
+        fwrite(VLOG_BINARY_MAGIC, 1, sizeof(magic), file);
+    }
+
+    *out_binary = binary;
+    return file;
+}
+
+// Finds or opens the sink of `_Stream`, returns NULL when the registry is full
+// or the file could not be opened. Failed opens are not kept, so they are retried.
+static vlog_sink_t* log_sink_get(const char* _Stream, int binary)
+{
+    for (size_t i = 0; i < vlog_sink_count; i++) {
+        if (strcmp(vlog_sinks[i].path, _Stream) == 0) {
+            return &vlog_sinks[i];
+        }
+    }
+
+    if (vlog_sink_count == VLOG_MAX_STREAMS || strlen(_Stream) >= VLOG_STREAM_MAX_LEN) {
+        return NULL;
+    }
+
+    vlog_sink_t* sink = &vlog_sinks[vlog_sink_count];
+    sink->file = log_file_open(_Stream, binary, &sink->binary);
+    if (!sink->file) {
+        return NULL;
+    }
+
+    setvbuf(sink->file, NULL, _IOFBF, VLOG_SINK_BUFFER_SIZE);
+    strcpy(sink->path, _Stream);
+    sink->pending = 0;
+    sink->last_flush = log_now_ms();
+    sink->formats = NULL;
+    sink->formats_size = 0;
+    vlog_sink_count++;
+    return sink;
+}
+
+// Flushes sinks whose flush interval ran out
+static void log_sinks_tick(void)
+{
+    uint64_t now = log_now_ms();
+    for (size_t i = 0; i < vlog_sink_count; i++) {
+        if (vlog_sinks[i].pending && now - vlog_sinks[i].last_flush >= VLOG_SINK_FLUSH_MS) {
+            log_sink_flush(&vlog_sinks[i], now);
+        }
+    }
+}
+
+static void log_sinks_flush_all(void)
+{
+    uint64_t now = log_now_ms();
+    for (size_t i = 0; i < vlog_sink_count; i++) {
+        log_sink_flush(&vlog_sinks[i], now);
+    }
+}
+
+static void log_sinks_close_all(void)
+{
+    for (size_t i = 0; i < vlog_sink_count; i++) {
+        if (vlog_sinks[i].file) {
+            fclose(vlog_sinks[i].file);
+        }
+        free(vlog_sinks[i].formats);
+    }
+    vlog_sink_count = 0;
 }
 
+static void log_sink_write(vlog_sink_t* sink, const void* data, size_t length, uint8_t level)
+{
+    fwrite(data, 1, length, sink->file);
+    sink->pending += length;
+
+    uint64_t now = log_now_ms();
+    if (level <= VLOG_LEVEL_ERROR || sink->pending >= VLOG_SINK_FLUSH_BYTES || now - sink->last_flush >= VLOG_SINK_FLUSH_MS) {
+        log_sink_flush(sink, now);
+    }
+}
+
+// Writes the definition of format `id` into a binary sink unless it is already there
+static void log_sink_define(vlog_sink_t* sink, uint32_t id)
+{
+    size_t byte = id / 8;
+    if (byte >= sink->formats_size) {
+        size_t new_size = (byte + 1) * 2;
+        uint8_t* new_formats = (uint8_t*)realloc(sink->formats, new_size);
+        if (!new_formats) return;
+        memset(new_formats + sink->formats_size, 0, new_size - sink->formats_size);
+        sink->formats = new_formats;
+        sink->formats_size = new_size;
+    }
+    if (sink->formats[byte] & (1u << (id % 8))) return;
+
+    const char* fmt = log_format_get(id);
+    size_t len = strlen(fmt);
+    vlog_bin_header_t header = {0};
+    header.type = VLOG_BIN_FORMAT;
+    header.length = (uint16_t)((len > UINT16_MAX)? UINT16_MAX : len);
+    header.id = id;
+
+    fwrite(&header, sizeof(header), 1, sink->file);
+    fwrite(fmt, 1, header.length, sink->file);
+    sink->pending += sizeof(header) + header.length;
+    sink->formats[byte] |= (uint8_t)(1u << (id % 8));
+}
+
+static void file_write(const char* _Stream, const char* message, size_t length, uint8_t level)
+{
+    vlog_sink_t* sink = log_sink_get(_Stream, 0);
+
+    if (!sink) {
+        // Registry is full or the open failed, fall back to a one-off write
+        FILE* file = fopen(_Stream, "a");
+        if (file) {
+            fwrite(message, sizeof(char), length, file);
+            fclose(file);
+        } else {
+            static const char warning[] = "[WARN]:  Failed to open or create file\n";
+            console_write(warning, sizeof(warning) - 1, VLOG_LEVEL_WARN);
+        }
+        return;
+    }
+
+    if (sink->binary) {
+        // Text going into a binary log is wrapped in a text record
+        vlog_bin_header_t header = {0};
+        header.type = VLOG_BIN_TEXT;
+        header.level = level;
+        header.length = (uint16_t)length;
+        header.time = log_now_ns();
+        fwrite(&header, sizeof(header), 1, sink->file);
+        sink->pending += sizeof(header);
+    }
+
+    log_sink_write(sink, message, length, level);
+}
+
+// Writes an encoded event (header + arguments), text streams get it formatted
+static void file_write_event(const char* _Stream, const unsigned char* record, size_t length)
+{
+    const vlog_bin_header_t* header = (const vlog_bin_header_t*)record;
+    vlog_sink_t* sink = log_sink_get(_Stream, 1);
+
+    if (sink && sink->binary) {
+        log_sink_define(sink, header->id);
+        log_sink_write(sink, record, length, header->level);
+        return;
+    }
+
+    char text[VLOG_MSG_MAX_LEN];
+    size_t text_length = log_bin_render(text, header->level, log_format_get(header->id), record + sizeof(*header), header->length);
+    file_write(_Stream, text, text_length, header->level);
+}
+
+/*
+    Mapped streams:
+    A mapped stream writes into the current one of two segment slots. Writers
+    register in the segment's `inflight` count, check that it is still current,
+    then claim bytes with an atomic add on `cursor` and copy without a lock.
+    The one claim that crosses the end records its offset in `end`; its writer
+    and everyone after it rotate under log_mutex. The segment a rotation replaces
+    stays mapped until the next rotation needs its slot, by then its writers are
+    long gone, so rotating never waits on them while holding the lock. Slots are
+    reused, so a writer that raced with two rotations simply lands in the fresh
+    segment.
+*/
+#define VLOG_MAP_NONE 2                 // `current` value while no segment is open
+
+typedef struct vlog_map_segment_t
+{
+    volatile size_t cursor;             // Next free offset, may run past `size`
+    char pad0[VLOG_CACHE_LINE - sizeof(size_t)];
+    volatile size_t inflight;           // Writers currently using the segment
+    char pad1[VLOG_CACHE_LINE - sizeof(size_t)];
+    size_t end;                         // Offset of the first claim that did not fit
+    size_t size;                        // Mapped size in bytes
+    char* base;                         // Start of the mapping
+    log_map_handle_t handle;
+} vlog_map_segment_t;
+
+typedef struct vlog_map_t
+{
+    char path[VLOG_STREAM_MAX_LEN];     // Stream path, segments are `path.<index>`
+    size_t segment_size;                // Size of new segments
+    unsigned index;                     // Index of the next segment file
+    volatile size_t current;            // Slot of the open segment, VLOG_MAP_NONE if closed
+    volatile size_t failed;             // 1 once a segment could not be opened
+    vlog_map_segment_t segments[2];
+} vlog_map_t;
+
+static vlog_map_t vlog_maps[VLOG_MAX_STREAMS];
+static volatile size_t vlog_map_count = 0;
+
+static vlog_map_t* log_map_find(const char* _Stream)
+{
+    size_t count = log_atomic_load(&vlog_map_count);
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(vlog_maps[i].path, _Stream) == 0) {
+            return &vlog_maps[i];
+        }
+    }
+    return NULL;
+}
+
+// Waits for the last writer of a segment that is no longer current and closes it
+static void log_map_retire(vlog_map_segment_t* segment)
+{
+    log_fence();
+    while (log_atomic_load(&segment->inflight) != 0) {
+        log_yield();
+    }
+
+    size_t keep = log_atomic_load(&segment->cursor);
+    if (keep > segment->end) {
+        keep = segment->end;
+    }
+    log_map_close(segment->base, segment->size, keep, &segment->handle);
+    segment->base = NULL;
+}
+
+// Replaces segment `index` with a fresh one unless another writer already did (caller holds log_mutex)
+static int log_map_rotate_locked(vlog_map_t* map, size_t index, size_t length)
+{
+    if (map->current != index) return 0;
+    if (index != VLOG_MAP_NONE) {
+        vlog_map_segment_t* segment = &map->segments[index];
+        if (log_atomic_load(&segment->cursor) + length <= segment->size) return 0;
+    }
+
+    size_t next = (index == 0)? 1 : 0;
+    vlog_map_segment_t* segment = &map->segments[next];
+    if (segment->base) {
+        // Replaced by the previous rotation
+        log_map_retire(segment);
+    }
+
+    char path[VLOG_STREAM_MAX_LEN + 16];
+    snprintf(path, sizeof(path), "%s.%u", map->path, map->index);
+
+    segment->base = log_map_open(path, map->segment_size, &segment->handle);
+    if (segment->base) {
+        map->index++;
+        segment->size = map->segment_size;
+        segment->end = segment->size;
+        log_atomic_store(&segment->cursor, 0);
+    } else {
+        next = VLOG_MAP_NONE;
+        log_atomic_store(&map->failed, 1);
+    }
+
+    log_atomic_store(&map->current, next);
+    return (next == VLOG_MAP_NONE)? -1 : 0;
+}
+
+static int log_map_rotate(vlog_map_t* map, size_t index, size_t length)
+{
+    log_lock();
+    int result = log_map_rotate_locked(map, index, length);
+    log_unlock();
+    return result;
+}
+
+// Copies a message into the mapped stream, returns -1 if the caller has to fall back to the file sink
+static int log_map_write(vlog_map_t* map, const char* data, size_t length)
+{
+    while (!log_atomic_load(&map->failed)) {
+        size_t index = log_atomic_load(&map->current);
+        if (index == VLOG_MAP_NONE) {
+            log_map_rotate(map, index, length);
+            continue;
+        }
+
+        vlog_map_segment_t* segment = &map->segments[index];
+        // Pairs with the fence in log_map_retire: either it waits for us or we see the rotation
+        log_atomic_add(&segment->inflight, 1);
+        log_fence();
+        if (log_atomic_load(&map->current) != index) {
+            log_atomic_add(&segment->inflight, (size_t)-1);
+            continue;
+        }
+
+        size_t offset = log_atomic_add(&segment->cursor, length);
+        if (offset + length <= segment->size) {
+            memcpy(segment->base + offset, data, length);
+            log_atomic_add(&segment->inflight, (size_t)-1);
+            return 0;
+        }
+        if (offset < segment->size) {
+            segment->end = offset;
+        }
+        log_atomic_add(&segment->inflight, (size_t)-1);
+
+        log_map_rotate(map, index, length);
+    }
+    return -1;
+}
+
+// Writes a formatted message to a mapped stream, echoing errors to the console like binary streams do
+static int log_map_text(vlog_map_t* map, const char* message, size_t length, uint8_t level)
+{
+    if (log_map_write(map, message, length) == -1) {
+        return -1;
+    }
+    if (level <= VLOG_LEVEL_ERROR) {
+        log_lock();
+        console_write(message, length, level);
+        log_unlock();
+    }
+    return 0;
+}
+
+static void log_maps_sync_all(void)
+{
+    for (size_t i = 0; i < vlog_map_count; i++) {
+        // The segment replaced by the last rotation may still be mapped too
+        for (size_t index = 0; index < 2; index++) {
+            vlog_map_segment_t* segment = &vlog_maps[i].segments[index];
+            if (segment->base) {
+                size_t length = log_atomic_load(&segment->cursor);
+                log_map_sync(segment->base, (length < segment->end)? length : segment->end);
+            }
+        }
+    }
+}
+
+static void log_maps_close_all(void)
+{
+    for (size_t i = 0; i < vlog_map_count; i++) {
+        vlog_map_t* map = &vlog_maps[i];
+        log_atomic_store(&map->current, VLOG_MAP_NONE);
+        for (size_t index = 0; index < 2; index++) {
+            if (map->segments[index].base) {
+                log_map_retire(&map->segments[index]);
+            }
+        }
+    }
+}
+
+int vloggerMapStream(const char* _Stream, size_t segment_size)
+{
+    if (!_Stream || strlen(_Stream) >= VLOG_STREAM_MAX_LEN) return -1;
+
+    segment_size = (segment_size)? segment_size : VLOG_MAP_SEGMENT_SIZE;
+    segment_size = (segment_size + 0xFFFFu) & ~(size_t)0xFFFFu;
+
+    int result = 0;
+    log_lock();
+    vlog_map_t* map = log_map_find(_Stream);
+    if (!map && vlog_map_count < VLOG_MAX_STREAMS) {
+        map = &vlog_maps[vlog_map_count];
+        strcpy(map->path, _Stream);
+        map->current = VLOG_MAP_NONE;
+
+        // Continue after the segments earlier runs left behind
+        char path[VLOG_STREAM_MAX_LEN + 16];
+        for (map->index = 0;; map->index++) {
+            snprintf(path, sizeof(path), "%s.%u", _Stream, map->index);
+            FILE* file = fopen(path, "rb");
+            if (!file) break;
+            fclose(file);
+        }
+        log_atomic_store(&vlog_map_count, vlog_map_count + 1);
+    }
+
+    if (map) {
+        map->segment_size = segment_size;
+        log_atomic_store(&map->failed, 0);
+        if (map->current == VLOG_MAP_NONE) {
+            result = log_map_rotate_locked(map, VLOG_MAP_NONE, 0);
+        }
+    } else {
+        result = -1;
+    }
+    log_unlock();
+    return result;
+}
+
+/*
+    Async ring buffer:
+    A bounded multi-producer queue where every slot carries a sequence number.
+    A slot at position `pos` is free for a producer when `seq == pos` and holds
+    a message for the writer when `seq == pos + 1`. Producers claim positions by
+    advancing `head` with a CAS, the single writer thread owns `tail`.
+*/
+typedef struct vlog_slot_t
+{
+    volatile size_t seq;                // Sequence number of the slot
+    uint8_t level;                      // Level of the queued message
+    uint8_t binary;                     // 1 if `message` holds an encoded event
+    size_t length;                      // Length of the formatted message
+    uint64_t time;                      // Monotonic timestamp the merger orders by (per-thread mode)
+    char stream[VLOG_STREAM_MAX_LEN];   // Copy of the stream path ("" = console only)
+    char message[VLOG_MSG_MAX_LEN];     // Formatted message
+} vlog_slot_t;
+
+/*
+    Per-thread buffers:
+    Each logging thread owns a single-producer ring of slots, so producers never
+    touch a shared counter. Before stamping a message the owner publishes a lower
+    bound of its timestamp in `busy`; the merger first reads the clock (W), then
+    every `busy`, and only writes messages stamped below min(W, busy). A producer
+    it saw as idle stamps at or after W, so nothing older can show up later.
+
+    A buffer is referenced by the logger while it is listed and by its owner
+    thread, and is freed when both let go. Shutdown only drops the logger's
+    reference, so a producer preempted between finding its buffer and setting
+    `busy` still writes into live memory; it then sees the new generation and
+    lets go. When a thread exits its buffer stays listed but unowned, and the
+    next thread to register takes it over instead of allocating another.
+*/
+typedef struct vlog_thread_buffer_t
+{
+    volatile size_t head;               // Next slot the owner fills
+    char pad0[VLOG_CACHE_LINE - sizeof(size_t)];
+    volatile size_t tail;               // Next slot the merger writes out
+    char pad1[VLOG_CACHE_LINE - sizeof(size_t)];
+    volatile uint64_t busy;             // Lower bound of the timestamp being written, 0 when idle
+    volatile size_t refs;               // 1 while listed + 1 while owned
+    size_t owned;                       // 1 while a live thread logs into it (changed under log_mutex)
+    vlog_slot_t* slots;
+    size_t mask;
+    struct vlog_thread_buffer_t* next;  // Buffers are only ever prepended while the logger runs, never unlinked
+} vlog_thread_buffer_t;
+
+typedef struct vlog_async_t
+{
+    volatile size_t head;               // Next position producers claim
+    char pad0[VLOG_CACHE_LINE - sizeof(size_t)];
+    volatile size_t tail;               // Next position the writer drains
+    char pad1[VLOG_CACHE_LINE - sizeof(size_t)];
+    volatile size_t inflight;           // Producers currently writing a slot
+    char pad2[VLOG_CACHE_LINE - sizeof(size_t)];
+    volatile size_t accepting;          // 1 while producers may use the ring
+    volatile size_t running;            // 1 while the writer thread should keep going
+    volatile size_t mode;               // VLOG_MODE the writer thread was started with
+    vlog_slot_t* slots;
+    size_t mask;
+    vlog_thread_buffer_t* threads;      // Registered thread buffers (per-thread mode)
+    size_t thread_slots;                // Slots in each thread buffer
+    volatile size_t generation;         // Bumped on every start, invalidates cached thread buffers
+    log_thread_t writer;
+} vlog_async_t;
+
+static vlog_async_t vlog_async;
+
+static vthread_local vlog_thread_buffer_t* vlog_thread_buffer = NULL;
+static vthread_local size_t vlog_thread_generation = 0;
+
+// Formats `[LEVEL]: message\n` into `out` and returns its length
+static size_t log_format(char* out, VLOG_LEVEL level, const char* message, va_list args)
+{
+    size_t prefix = strlen(lvls[level]);
+    memcpy(out, lvls[level], prefix);
+
+    int written = vsnprintf(out + prefix, VLOG_MSG_MAX_LEN - prefix - 1, message, args);
+    size_t length = prefix + ((written < 0)? 0 : (size_t)written);
+    if (length > VLOG_MSG_MAX_LEN - 2) {
+        length = VLOG_MSG_MAX_LEN - 2;
+    }
+
+    out[length++] = '\n';
+    out[length] = '\0';
+    return length;
+}
+
+// Writes a formatted message to the console and to `_Stream` if given (caller holds log_mutex)
+static void log_write(const char* _Stream, const char* out_message, size_t length, uint8_t level)
+{
+    console_write(out_message, length, level);
+
+    if (_Stream && _Stream[0]) {
+        file_write(_Stream, out_message, length, level);
+    }
+}
+
+// Writes an encoded event, only formatting it when it has to reach the console or a text stream
+static void log_write_event(const char* _Stream, const unsigned char* record, size_t length)
+{
+    const vlog_bin_header_t* header = (const vlog_bin_header_t*)record;
+    int has_stream = (_Stream && _Stream[0]);
+
+    if (!has_stream || header->level <= VLOG_LEVEL_ERROR) {
+        char text[VLOG_MSG_MAX_LEN];
+        size_t text_length = log_bin_render(text, header->level, log_format_get(header->id), record + sizeof(*header), header->length);
+        console_write(text, text_length, header->level);
+    }
+
+    if (has_stream) {
+        file_write_event(_Stream, record, length);
+    }
+}
+
+// Writes out a drained slot (caller holds log_mutex)
+static void log_slot_write(const vlog_slot_t* slot)
+{
+    if (slot->binary) {
+        log_write_event(slot->stream, (const unsigned char*)slot->message, slot->length);
+    } else {
+        log_write(slot->stream, slot->message, slot->length, slot->level);
+    }
+}
+
+static void log_thread_buffer_release(vlog_thread_buffer_t* buffer)
+{
+    if (log_atomic_add(&buffer->refs, (size_t)-1) == 1) {
+        free(buffer->slots);
+        free(buffer);
+    }
+}
+
+// Runs when a thread that registered a buffer exits, leaves the buffer to the next thread
+static void log_thread_exit(void* value)
+{
+    vlog_thread_buffer_t* buffer = (vlog_thread_buffer_t*)value;
+
+    log_lock();
+    buffer->owned = 0;
+    log_unlock();
+    log_thread_buffer_release(buffer);
+}
+
+// Returns the calling thread's buffer, registering one on first use (NULL when not accepting)
+static vlog_thread_buffer_t* log_thread_buffer_get(void)
+{
+    size_t generation = log_atomic_load(&vlog_async.generation);
+    if (vlog_thread_buffer && vlog_thread_generation == generation) {
+        return vlog_thread_buffer;
+    }
+
+    vlog_thread_buffer_t* buffer = NULL;
+    log_lock();
+    if (log_atomic_load(&vlog_async.accepting)) {
+        // Take over the buffer of a thread that exited before allocating a new one
+        for (buffer = vlog_async.threads; buffer && buffer->owned; buffer = buffer->next) {}
+
+        if (!buffer) {
+            buffer = (vlog_thread_buffer_t*)calloc(1, sizeof(vlog_thread_buffer_t));
+            if (buffer) {
+                buffer->slots = (vlog_slot_t*)malloc(vlog_async.thread_slots * sizeof(vlog_slot_t));
+                if (buffer->slots) {
+                    buffer->refs = 1;
+                    buffer->mask = vlog_async.thread_slots - 1;
+                    buffer->next = vlog_async.threads;
+                    vlog_async.threads = buffer;
+                } else {
+                    free(buffer);
+                    buffer = NULL;
+                }
+            }
+        }
+        if (buffer) {
+            buffer->owned = 1;
+            log_atomic_add(&buffer->refs, 1);
+        }
+    }
+    log_thread_on_exit(buffer);
+    log_unlock();
+
+    if (vlog_thread_buffer) {
+        // Left over from an earlier start, the logger already let go of it
+        log_thread_buffer_release(vlog_thread_buffer);
+    }
+
+    // On failure the thread stays on the synchronous path until the next start
+    vlog_thread_buffer = buffer;
+    vlog_thread_generation = generation;
+    return buffer;
+}
+
+// Claims the next slot of the calling thread's buffer and stamps it
+static vlog_slot_t* log_thread_acquire(void)
+{
+    vlog_thread_buffer_t* buffer;
+
+    for (;;) {
+        buffer = log_thread_buffer_get();
+        if (!buffer) return NULL;
+
+        // Pairs with the fence in vloggerShutdown: either it waits for `busy` or we see `accepting` cleared
+        log_atomic_store64(&buffer->busy, log_now_ns());
+        log_fence();
+        if (!log_atomic_load(&vlog_async.accepting)) {
+            log_atomic_store64(&buffer->busy, 0);
+            return NULL;
+        }
+        if (log_atomic_load(&vlog_async.generation) == vlog_thread_generation) {
+            break;
+        }
+
+        // The logger was restarted after the buffer was looked up, it is no longer drained
+        log_atomic_store64(&buffer->busy, 0);
+    }
+
+    // Everything already queued is stamped below `busy`, so the merger keeps draining while we wait
+    while (buffer->head - log_atomic_load(&buffer->tail) > buffer->mask) {
+        log_yield();
+    }
+
+    vlog_slot_t* slot = &buffer->slots[buffer->head & buffer->mask];
+    slot->time = log_now_ns();
+    return slot;
+}
+
+static void log_thread_publish(void)
+{
+    vlog_thread_buffer_t* buffer = vlog_thread_buffer;
+    log_atomic_store(&buffer->head, buffer->head + 1);
+    log_atomic_store64(&buffer->busy, 0);
+}
+
+// Claims a ring slot, returns NULL if the ring is not accepting messages
+static vlog_slot_t* log_async_acquire(size_t* out_pos)
+{
+    if (log_atomic_load(&vlog_async.mode) == VLOG_MODE_PER_THREAD) {
+        return log_thread_acquire();
+    }
+
+    // Synchronous mode never touches the shared counter
+    if (!log_atomic_load(&vlog_async.accepting)) {
+        return NULL;
+    }
+
+    // Pairs with the fence in vloggerShutdown: either it sees us in `inflight` or we see `accepting` cleared
+    log_atomic_add(&vlog_async.inflight, 1);
+    log_fence();
+    if (!log_atomic_load(&vlog_async.accepting)) {
+        log_atomic_add(&vlog_async.inflight, (size_t)-1);
+        return NULL;
+    }
+
+    size_t pos = log_atomic_load(&vlog_async.head);
+    for (;;) {
+        vlog_slot_t* slot = &vlog_async.slots[pos & vlog_async.mask];
+        size_t seq = log_atomic_load(&slot->seq);
+
+        if (seq == pos) {
+            if (log_atomic_cas(&vlog_async.head, pos, pos + 1)) {
+                *out_pos = pos;
+                slot->time = 0;
+                return slot;
+            }
+        } else if ((ptrdiff_t)(seq - pos) < 0) {
+            // Ring is full, wait for the writer to free a slot
+            log_yield();
+        }
+        pos = log_atomic_load(&vlog_async.head);
+    }
+}
+
+static void log_async_publish(vlog_slot_t* slot, size_t pos)
+{
+    if (vlog_async.mode == VLOG_MODE_PER_THREAD) {
+        log_thread_publish();
+        return;
+    }
+
+    log_atomic_store(&slot->seq, pos + 1);
+    log_atomic_add(&vlog_async.inflight, (size_t)-1);
+}
+
+// Drains up to VLOG_ASYNC_BATCH messages, returns how many were written
+static size_t log_async_drain(void)
+{
+    size_t tail = vlog_async.tail;
+    size_t count = 0;
+
+    log_lock();
+    while (count < VLOG_ASYNC_BATCH) {
+        vlog_slot_t* slot = &vlog_async.slots[tail & vlog_async.mask];
+        if (log_atomic_load(&slot->seq) != tail + 1) {
+            break;
+        }
+
+        log_slot_write(slot);
+
+        log_atomic_store(&slot->seq, tail + vlog_async.mask + 1);
+        tail++;
+        count++;
+    }
+    log_unlock();
+
+    log_atomic_store(&vlog_async.tail, tail);
+    return count;
+}
+
+// Merges up to VLOG_ASYNC_BATCH messages from the thread buffers in timestamp order
+static size_t log_thread_drain(int final)
+{
+    uint64_t limit = UINT64_MAX;
+    size_t count = 0;
+
+    if (!final) {
+        limit = log_now_ns();
+        log_fence();
+    }
+
+    log_lock();
+    if (!final) {
+        for (vlog_thread_buffer_t* buffer = vlog_async.threads; buffer; buffer = buffer->next) {
+            uint64_t busy = log_atomic_load64(&buffer->busy);
+            if (busy && busy < limit) {
+                limit = busy;
+            }
+        }
+    }
+
+    while (count < VLOG_ASYNC_BATCH) {
+        vlog_thread_buffer_t* oldest = NULL;
+        vlog_slot_t* slot = NULL;
+
+        for (vlog_thread_buffer_t* buffer = vlog_async.threads; buffer; buffer = buffer->next) {
+            size_t tail = buffer->tail;
+            if (tail == log_atomic_load(&buffer->head)) continue;
+
+            vlog_slot_t* first = &buffer->slots[tail & buffer->mask];
+            if (first->time < limit && (!slot || first->time < slot->time)) {
+                oldest = buffer;
+                slot = first;
+            }
+        }
+        if (!oldest) break;
+
+        log_slot_write(slot);
+        log_atomic_store(&oldest->tail, oldest->tail + 1);
+        count++;
+    }
+    log_unlock();
+
+    return count;
+}
+
+static size_t log_writer_drain(int final)
+{
+    return (vlog_async.mode == VLOG_MODE_PER_THREAD)? log_thread_drain(final) : log_async_drain();
+}
+
+static void log_writer_run(void)
+{
+    for (;;) {
+        if (log_writer_drain(0) != 0) {
+            continue;
+        }
+        if (!log_atomic_load(&vlog_async.running)) {
+            // Producers are gone by now, one last pass catches anything published late
+            while (log_writer_drain(1) != 0) {}
+            return;
+        }
+
+        log_lock();
+        log_sinks_tick();
+        log_unlock();
+
+        log_sleep_ms(1);
+    }
+}
+
+int vloggerStart(VLOG_MODE mode, size_t capacity)
+{
+    vloggerShutdown();
+
+    if (mode == VLOG_MODE_SYNC) {
+        return 0;
+    }
+
+    size_t slots = 2;
+    if (!capacity) {
+        capacity = (mode == VLOG_MODE_PER_THREAD)? VLOG_THREAD_DEFAULT_CAPACITY : VLOG_ASYNC_DEFAULT_CAPACITY;
+    }
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    if (mode == VLOG_MODE_PER_THREAD) {
+        // Thread buffers are allocated by each thread on its first message
+        vlog_async.thread_slots = slots;
+        vlog_async.threads = NULL;
+        log_atomic_store(&vlog_async.generation, vlog_async.generation + 1);
+        log_atomic_store(&vlog_async.mode, (size_t)mode);
+        log_atomic_store(&vlog_async.running, 1);
+
+        if (log_thread_start(&vlog_async.writer) == -1) {
+            vlog_async.running = 0;
+            log_atomic_store(&vlog_async.mode, VLOG_MODE_SYNC);
+            return -1;
+        }
+
+        log_atomic_store(&vlog_async.accepting, 1);
+        return 0;
+    }
+
+    vlog_async.slots = (vlog_slot_t*)malloc(slots * sizeof(vlog_slot_t));
+    if (!vlog_async.slots) return -1;
+
+    for (size_t i = 0; i < slots; i++) {
+        vlog_async.slots[i].seq = i;
+    }
+    vlog_async.mask = slots - 1;
+    vlog_async.head = 0;
+    vlog_async.tail = 0;
+    vlog_async.inflight = 0;
+    log_atomic_store(&vlog_async.mode, (size_t)mode);
+    log_atomic_store(&vlog_async.running, 1);
+
+    if (log_thread_start(&vlog_async.writer) == -1) {
+        vlog_async.running = 0;
+        log_atomic_store(&vlog_async.mode, VLOG_MODE_SYNC);
+        free(vlog_async.slots);
+        vlog_async.slots = NULL;
+        return -1;
+    }
+
+    log_atomic_store(&vlog_async.accepting, 1);
+    return 0;
+}
+
+void vloggerFlush(void)
+{
+    if (log_atomic_load(&vlog_async.running) && vlog_async.mode == VLOG_MODE_PER_THREAD) {
+        log_lock();
+        vlog_thread_buffer_t* buffer = vlog_async.threads;
+        log_unlock();
+
+        // Links never change once published, so the list can be walked without the lock
+        for (; buffer; buffer = buffer->next) {
+            size_t target = log_atomic_load(&buffer->head);
+            while ((ptrdiff_t)(log_atomic_load(&buffer->tail) - target) < 0) {
+                log_yield();
+            }
+        }
+    } else if (log_atomic_load(&vlog_async.running)) {
+        size_t target = log_atomic_load(&vlog_async.head);
+        while ((ptrdiff_t)(log_atomic_load(&vlog_async.tail) - target) < 0) {
+            log_yield();
+        }
+    }
+
+    log_lock();
+    log_sinks_flush_all();
+    log_maps_sync_all();
+    fflush(stdout);
+    fflush(stderr);
+    log_unlock();
+}
+
+void vloggerShutdown(void)
+{
+    if (log_atomic_load(&vlog_async.running)) {
+        // Stop new producers and wait for the ones already inside the ring
+        log_atomic_store(&vlog_async.accepting, 0);
+        log_fence();
+        if (vlog_async.mode == VLOG_MODE_PER_THREAD) {
+            // Registration checks `accepting` under the lock, so the list is final after this
+            log_lock();
+            log_unlock();
+            for (vlog_thread_buffer_t* buffer = vlog_async.threads; buffer; buffer = buffer->next) {
+                while (log_atomic_load64(&buffer->busy) != 0) {
+                    log_yield();
+                }
+            }
+        }
+        while (log_atomic_load(&vlog_async.inflight) != 0) {
+            log_yield();
+        }
+
+        log_atomic_store(&vlog_async.running, 0);
+        log_thread_join(vlog_async.writer);
+
+        // Threads that still own a buffer free it once they notice the new generation or exit
+        log_lock();
+        vlog_thread_buffer_t* buffer = vlog_async.threads;
+        vlog_async.threads = NULL;
+        if (vlog_thread_buffer) {
+            // The calling thread lets go of its own buffer right away
+            log_thread_on_exit(NULL);
+        }
+        log_unlock();
+        if (vlog_thread_buffer) {
+            log_thread_buffer_release(vlog_thread_buffer);
+            vlog_thread_buffer = NULL;
+        }
+        while (buffer) {
+            vlog_thread_buffer_t* next = buffer->next;
+            log_thread_buffer_release(buffer);
+            buffer = next;
+        }
+        free(vlog_async.slots);
+        vlog_async.slots = NULL;
+        log_atomic_store(&vlog_async.mode, VLOG_MODE_SYNC);
+    }
+
+    log_lock();
+    log_sinks_close_all();
+    log_maps_close_all();
+    fflush(stdout);
+    fflush(stderr);
+    log_unlock();
+}
+
+/*
+    Channel registry:
+    Runtime thresholds per stream path. Channels are never removed, so call sites
+    may keep pointers to them. Lookups read the published count and compare paths
+    without locking; new channels are added under log_mutex.
+*/
+typedef struct vlog_channel_entry_t
+{
+    vlog_channel_t channel;             // Public part the call sites read
+    char path[VLOG_STREAM_MAX_LEN];     // Stream path of the channel
+    int custom;                         // 1 once vloggerSetLevel was used on it
+} vlog_channel_entry_t;
+
+static vlog_channel_entry_t vlog_channels[VLOG_MAX_STREAMS];
+static volatile size_t vlog_channel_count = 0;
+static volatile long vlog_default_level = VLOG_LEVEL_TRACE;
+
+// Console only messages (NULL or empty stream)
+static vlog_channel_entry_t vlog_channel_console = { { vlog_channel_console.path, VLOG_LEVEL_TRACE }, "", 0 };
+
+// Shared by streams that did not fit in the registry, its NULL path never matches a call site
+static vlog_channel_entry_t vlog_channel_overflow = { { NULL, VLOG_LEVEL_TRACE }, "", 0 };
+
+static vlog_channel_entry_t* log_channel_find(const char* _Stream)
+{
+    if (!_Stream || !_Stream[0]) return &vlog_channel_console;
+
+    size_t count = log_atomic_load(&vlog_channel_count);
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(vlog_channels[i].path, _Stream) == 0) {
+            return &vlog_channels[i];
+        }
+    }
+    return NULL;
+}
+
+static vlog_channel_entry_t* log_channel_get(const char* _Stream)
+{
+    vlog_channel_entry_t* entry = log_channel_find(_Stream);
+    if (entry) return entry;
+
+    // Overflow streams miss every call site cache, keep them off the lock
+    if (log_atomic_load(&vlog_channel_count) == VLOG_MAX_STREAMS || strlen(_Stream) >= VLOG_STREAM_MAX_LEN) {
+        return &vlog_channel_overflow;
+    }
+
+    log_lock();
+    entry = log_channel_find(_Stream);
+    if (!entry) {
+        size_t count = vlog_channel_count;
+        if (count == VLOG_MAX_STREAMS || strlen(_Stream) >= VLOG_STREAM_MAX_LEN) {
+            entry = &vlog_channel_overflow;
+        } else {
+            entry = &vlog_channels[count];
+            strcpy(entry->path, _Stream);
+            entry->channel.path = entry->path;
+            entry->channel.level = vlog_default_level;
+            entry->custom = 0;
+            log_atomic_store(&vlog_channel_count, count + 1);
+        }
+    }
+    log_unlock();
+    return entry;
+}
+
+vlog_channel_t* _vloggerChannel(const char* _Stream)
+{
+    return &log_channel_get(_Stream)->channel;
+}
+
+void vloggerSetLevel(const char* _Stream, VLOG_LEVEL level)
+{
+    vlog_channel_entry_t* entry = log_channel_get(_Stream);
+    if (entry == &vlog_channel_overflow) return;
+
+    entry->custom = 1;
+    entry->channel.level = (long)level;
+}
+
+VLOG_LEVEL vloggerGetLevel(const char* _Stream)
+{
+    return (VLOG_LEVEL)log_channel_get(_Stream)->channel.level;
+}
+
+void vloggerSetDefaultLevel(VLOG_LEVEL level)
+{
+    log_lock();
+    vlog_default_level = (long)level;
+    if (!vlog_channel_console.custom) {
+        vlog_channel_console.channel.level = (long)level;
+    }
+    vlog_channel_overflow.channel.level = (long)level;
+    for (size_t i = 0; i < vlog_channel_count; i++) {
+        if (!vlog_channels[i].custom) {
+            vlog_channels[i].channel.level = (long)level;
+        }
+    }
+    log_unlock();
+}
+
+static void log_text(const char* _Stream, VLOG_LEVEL level, const char* message, va_list arg_ptr)
+{
+    size_t pos = 0;
+    vlog_slot_t* slot = NULL;
+    vlog_map_t* map = (_Stream && log_atomic_load(&vlog_map_count))? log_map_find(_Stream) : NULL;
+
+    if (!map && (!_Stream || strlen(_Stream) < VLOG_STREAM_MAX_LEN)) {
+        slot = log_async_acquire(&pos);
+    }
+
+    if (slot) {
+        // Async: format straight into the claimed slot, the writer does the I/O
+        slot->length = log_format(slot->message, level, message, arg_ptr);
+        slot->level = (uint8_t)level;
+        slot->binary = 0;
+        if (_Stream) {
+            strcpy(slot->stream, _Stream);
+        } else {
+            slot->stream[0] = '\0';
+        }
+
+        log_async_publish(slot, pos);
+        return;
+    }
+
+    char out_message[VLOG_MSG_MAX_LEN];
+    size_t length = log_format(out_message, level, message, arg_ptr);
+
+    if (map && log_map_text(map, out_message, length, (uint8_t)level) == 0) {
+        return;
+    }
+
+    log_lock();
+    log_write(_Stream, out_message, length, level);
+    log_unlock();
+}
+
+void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
+{
+    if ((long)level > VLOG_LOAD_RELAXED(&log_channel_get(_Stream)->channel.level)) return;
+
+    va_list arg_ptr;
+    va_start(arg_ptr, message);
+    log_text(_Stream, level, message, arg_ptr);
+    va_end(arg_ptr);
+}
+
+void _vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
+{
+    va_list arg_ptr;
+    va_start(arg_ptr, message);
+    log_text(_Stream, level, message, arg_ptr);
+    va_end(arg_ptr);
+}
+
+void vloggerLogBinary(const char* _Stream, VLOG_LEVEL level, uint32_t* fmt_id, const char* message, ...)
+{
+    va_list arg_ptr;
+    uint32_t id = *(volatile uint32_t*)fmt_id;
+
+    if (!id) {
+        id = log_format_register(fmt_id, message);
+        if (!id) return;
+    }
+
+    vlog_bin_header_t header = {0};
+    header.type = VLOG_BIN_EVENT;
+    header.level = (uint8_t)level;
+    header.id = id;
+
+    size_t pos = 0;
+    vlog_slot_t* slot = NULL;
+    vlog_map_t* map = (_Stream && log_atomic_load(&vlog_map_count))? log_map_find(_Stream) : NULL;
+
+    if (!map && (!_Stream || strlen(_Stream) < VLOG_STREAM_MAX_LEN)) {
+        slot = log_async_acquire(&pos);
+    }
+    // Per-thread slots are already stamped, the merger orders events by that time
+    header.time = (slot && slot->time)? slot->time : log_now_ns();
+
+    unsigned char local[VLOG_MSG_MAX_LEN];
+    unsigned char* record = (slot)? (unsigned char*)slot->message : local;
+
+    va_start(arg_ptr, message);
+    header.length = (uint16_t)log_bin_encode(record + sizeof(header), VLOG_MSG_MAX_LEN - sizeof(header), message, arg_ptr);
+    va_end(arg_ptr);
+    memcpy(record, &header, sizeof(header));
+
+    if (slot) {
+        slot->level = (uint8_t)level;
+        slot->binary = 1;
+        slot->length = sizeof(header) + header.length;
+        if (_Stream) {
+            strcpy(slot->stream, _Stream);
+        } else {
+            slot->stream[0] = '\0';
+        }
+
+        log_async_publish(slot, pos);
+        return;
+    }
+
+    if (map) {
+        char text[VLOG_MSG_MAX_LEN];
+        size_t text_length = log_bin_render(text, header.level, message, record + sizeof(header), header.length);
+        if (log_map_text(map, text, text_length, header.level) == 0) {
+            return;
+        }
+    }
+
+    log_lock();
+    log_write_event(_Stream, record, sizeof(header) + header.length);
+    log_unlock();
+}
+
+long vloggerDecodeFile(const char* path, FILE* out)
+{
+    char magic[sizeof(VLOG_BINARY_MAGIC) - 1];
+    FILE* file = fopen(path, "rb");
+    if (!file) return -1;
+
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, VLOG_BINARY_MAGIC, sizeof(magic)) != 0) {
+        fclose(file);
+        return -1;
+    }
+
+    char** formats = NULL;
+    uint32_t format_cap = 0;
+    unsigned char* payload = (unsigned char*)malloc(UINT16_MAX + 1);
+    char text[VLOG_MSG_MAX_LEN];
+    uint64_t first_time = 0;
+    long count = 0;
+    vlog_bin_header_t header;
+
+    while (payload && fread(&header, sizeof(header), 1, file) == 1) {
+        if (fread(payload, 1, header.length, file) != header.length) break;
+
+        if (header.type == VLOG_BIN_FORMAT) {
+            if (header.id >= format_cap) {
+                uint32_t new_cap = (header.id + 1) * 2;
+                char** new_formats = (char**)realloc(formats, new_cap * sizeof(char*));
+                if (!new_formats) break;
+                memset(new_formats + format_cap, 0, (new_cap - format_cap) * sizeof(char*));
+                formats = new_formats;
+                format_cap = new_cap;
+            }
+            free(formats[header.id]);
+            formats[header.id] = (char*)malloc(header.length + 1u);
+            if (formats[header.id]) {
+                memcpy(formats[header.id], payload, header.length);
+                formats[header.id][header.length] = '\0';
+            }
+            continue;
+        }
+
+        if (header.level > VLOG_LEVEL_TRACE) continue;
+        if (!count) first_time = header.time;
+        count++;
+
+        fprintf(out, "[%12.6f] ", (double)(int64_t)(header.time - first_time) / 1e9);
+        if (header.type == VLOG_BIN_TEXT) {
+            fwrite(payload, 1, header.length, out);
+        } else if (header.id < format_cap && formats[header.id]) {
+            size_t length = log_bin_render(text, header.level, formats[header.id], payload, header.length);
+            fwrite(text, 1, length, out);
+        } else {
+            fprintf(out, "%s<unknown format %u>\n", lvls[header.level], (unsigned)header.id);
+        }
+    }
+
+    for (uint32_t i = 0; i < format_cap; i++) {
+        free(formats[i]);
+    }
+    free(formats);
+    free(payload);
+    fclose(file);
+    return count;
+}
@@ -7,8 +7,11 @@
 	https://github.com/ntpeters/SimpleLogger
 */ 
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 // Internal size of the logger, equivalent to the size of a pointer
 #define VLOGGER_INTERNAL_SIZE (sizeof(void*))
@@ -16,19 +19,47 @@
 // Maximum length for log messages (1024 characters)
 #define VLOG_MSG_MAX_LEN (512 * 2)
 
-// Enable logging for warnings and informational messages
-#define VLOG_WARN_ENABLED 1
-#define VLOG_INFO_ENABLED 1
-
-// Disable debug and trace logging for release builds
+// Least severe level that is compiled in (0 = FATAL ... 5 = TRACE, same values as VLOG_LEVEL).
+// Calls to less severe levels are removed entirely, their arguments are never evaluated.
+#ifndef VLOG_MIN_LEVEL
 #if defined(DEBUG) || defined(DEBUG)
-    // Enable debug and trace logging in debug builds
-    #define VLOG_DEBUG_ENABLED 1
-    #define VLOG_TRACE_ENABLED 1
+    // Keep debug and trace logging in debug builds
+    #define VLOG_MIN_LEVEL 5
+#else
+    // Stop at informational messages in release builds
+    #define VLOG_MIN_LEVEL 3
+#endif
+#endif
+
+// Which of the levels below fatal are compiled in
+#define VLOG_ERROR_ENABLED (VLOG_MIN_LEVEL >= 1)
+#define VLOG_WARN_ENABLED (VLOG_MIN_LEVEL >= 2)
+#define VLOG_INFO_ENABLED (VLOG_MIN_LEVEL >= 3)
+#define VLOG_DEBUG_ENABLED (VLOG_MIN_LEVEL >= 4)
+#define VLOG_TRACE_ENABLED (VLOG_MIN_LEVEL >= 5)
+
+// Reads a runtime level threshold with a single relaxed atomic load,
+// and publishes / reads the per call site channel pointer
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_ARM) || defined(_M_ARM64) || defined(_M_ARM64EC))
+    // ARM builds default to /volatile:iso, so volatile accesses need explicit barriers (0xB = ISH)
+    #include <intrin.h>
+    #define VLOG_LOAD_RELAXED(ptr) (*(ptr))
+    #define VLOG_LOAD_ACQUIRE(ptr) _vlog_load_acquire((void* volatile*)(ptr))
+    #define VLOG_STORE_RELEASE(ptr, val) _vlog_store_release((void* volatile*)(ptr), (val))
+    static __forceinline void* _vlog_load_acquire(void* volatile* ptr) { void* val = *ptr; __dmb(0xB); return val; }
+    static __forceinline void _vlog_store_release(void* volatile* ptr, const void* val) { __dmb(0xB); *ptr = (void*)val; }
+#elif defined(_MSC_VER) && !defined(__clang__)
+    // x86 and x64 are strongly ordered, volatile accesses only need to stay in place
+    #include <intrin.h>
+    #define VLOG_LOAD_RELAXED(ptr) (*(ptr))
+    #define VLOG_LOAD_ACQUIRE(ptr) _vlog_load_acquire((void* volatile*)(ptr))
+    #define VLOG_STORE_RELEASE(ptr, val) _vlog_store_release((void* volatile*)(ptr), (val))
+    static __forceinline void* _vlog_load_acquire(void* volatile* ptr) { void* val = *ptr; _ReadWriteBarrier(); return val; }
+    static __forceinline void _vlog_store_release(void* volatile* ptr, const void* val) { _ReadWriteBarrier(); *ptr = (void*)val; }
 #else
-    // Disable debug and trace logging in release builds
-    #define VLOG_DEBUG_ENABLED 0
-    #define VLOG_TRACE_ENABLED 0
+    #define VLOG_LOAD_RELAXED(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+    #define VLOG_LOAD_ACQUIRE(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define VLOG_STORE_RELEASE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
 #endif
 
 // Enum defining various logging levels
@@ -41,6 +72,100 @@ typedef enum VLOG_LEVEL {
     VLOG_LEVEL_TRACE = 5   // Trace messages (available in debug builds)
 } VLOG_LEVEL;
 
+// Default number of slots in the async ring buffer (must be a power of two)
+#define VLOG_ASYNC_DEFAULT_CAPACITY 1024
+
+// Maximum number of messages the writer thread drains before writing them out
+#define VLOG_ASYNC_BATCH 64
+
+// Default number of slots in each thread's buffer in per-thread mode (must be a power of two)
+#define VLOG_THREAD_DEFAULT_CAPACITY 256
+
+// Maximum length of a stream path that can be queued in async mode
+#define VLOG_STREAM_MAX_LEN 256
+
+// Maximum number of stream files the logger keeps open at the same time
+#ifndef VLOG_MAX_STREAMS
+#define VLOG_MAX_STREAMS 32
+#endif
+
+// Size of the stdio buffer given to each open stream file
+#ifndef VLOG_SINK_BUFFER_SIZE
+#define VLOG_SINK_BUFFER_SIZE (64 * 1024)
+#endif
+
+// A stream file is flushed once this many bytes are pending...
+#ifndef VLOG_SINK_FLUSH_BYTES
+#define VLOG_SINK_FLUSH_BYTES (32 * 1024)
+#endif
+
+// ...or once this many milliseconds passed since its last flush
+#ifndef VLOG_SINK_FLUSH_MS
+#define VLOG_SINK_FLUSH_MS 250
+#endif
+
+// Default size of a memory-mapped stream segment, see vloggerMapStream
+#ifndef VLOG_MAP_SEGMENT_SIZE
+#define VLOG_MAP_SEGMENT_SIZE (4u * 1024u * 1024u)
+#endif
+
+// When 1, VFATAL..VTRACE record a format-string id, a timestamp and the raw argument
+// bytes instead of formatting the message (decode the log with tools/vlog_decode.c)
+#ifndef VLOG_BINARY
+#define VLOG_BINARY 0
+#endif
+
+// Magic bytes at the start of a binary log file
+#define VLOG_BINARY_MAGIC "VLOGBIN1"
+
+// Enum defining the kinds of records in a binary log file
+typedef enum VLOG_BIN_RECORD {
+    VLOG_BIN_FORMAT = 'F', // Defines a format string, payload is the format string
+    VLOG_BIN_EVENT = 'E',  // A log call, payload is the raw argument bytes
+    VLOG_BIN_TEXT = 'T'    // An already formatted message, payload is the text
+} VLOG_BIN_RECORD;
+
+// Header in front of every record of a binary log file
+typedef struct vlog_bin_header_t {
+    uint8_t type;          // VLOG_BIN_RECORD
+    uint8_t level;         // VLOG_LEVEL of the message
+    uint16_t length;       // Number of payload bytes following the header
+    uint32_t id;           // Format string id (0 for text records)
+    uint64_t time;         // Monotonic timestamp in nanoseconds
+} vlog_bin_header_t;
+
+/*
+    Runtime threshold of a stream. Each call site caches the channel of its stream
+    together with the stream pointer it was looked up with. A call with the same
+    literal pointer only compares pointers, any other stream falls back to a strcmp
+    against the channel's path, so checking whether a message is wanted costs at most
+    one short strcmp and one relaxed load of `level` before any argument is evaluated.
+    Matching by contents keeps reused path buffers and copies of the same path correct.
+*/
+typedef struct vlog_channel_t {
+    const char* path;      // The channel's own copy of the stream path ("" for the console), NULL if shared
+    volatile long level;   // Least severe VLOG_LEVEL that is logged
+} vlog_channel_t;
+
+// Whether `channel` is the one of `_Stream`, the shared overflow channel never matches
+#define _VLOG_CHANNEL_MATCH(channel, _Stream) \
+    ((channel)->path && strcmp((channel)->path, (_Stream)? (_Stream) : "") == 0)
+
+// Whether `_Stream` is the same pointer to the same path on every call (a literal or NULL),
+// only then may a call site trust a pointer hit without comparing the contents
+#if defined(__GNUC__) || defined(__clang__)
+    #define _VLOG_STREAM_FIXED(_Stream) __builtin_constant_p(_Stream)
+#else
+    #define _VLOG_STREAM_FIXED(_Stream) 0
+#endif
+
+// Enum defining how log messages reach their stream
+typedef enum VLOG_MODE {
+    VLOG_MODE_SYNC = 0,       // The caller formats and writes the message under a lock (default)
+    VLOG_MODE_ASYNC = 1,      // The caller formats into a ring buffer slot, a writer thread does the I/O
+    VLOG_MODE_PER_THREAD = 2  // The caller formats into its own thread's buffer, a merger thread writes them in time order
+} VLOG_MODE;
+
 /**
  * @brief Logs a message with a specified log level.
  *
@@ -55,6 +180,162 @@ typedef enum VLOG_LEVEL {
  */
 void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...);
 
+/**
+ * @brief Same as `vloggerLog` but without checking the runtime threshold of the stream.
+ * Used by the logging macros, which already checked it.
+ */
+void _vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...);
+
+/**
+ * @brief Sets the runtime threshold of a stream.
+ *
+ * Messages less severe than `level` are dropped before they are formatted.
+ * This can be changed at any time from any thread.
+ *
+ * @param _Stream The stream path, or NULL for console only messages.
+ * @param level Least severe level that is still logged.
+ */
+void vloggerSetLevel(const char* _Stream, VLOG_LEVEL level);
+
+/**
+ * @brief Gets the runtime threshold of a stream.
+ *
+ * @param _Stream The stream path, or NULL for console only messages.
+ * @return Least severe level that is still logged.
+ */
+VLOG_LEVEL vloggerGetLevel(const char* _Stream);
+
+/**
+ * @brief Sets the runtime threshold of every stream that has not been given its own
+ * with `vloggerSetLevel` (defaults to `VLOG_LEVEL_TRACE`, so everything compiled in is logged).
+ *
+ * @param level Least severe level that is still logged.
+ */
+void vloggerSetDefaultLevel(VLOG_LEVEL level);
+
+/**
+ * @brief Returns the channel holding the runtime threshold of `_Stream`, creating it if needed.
+ * @note Used by the logging macros.
+ */
+vlog_channel_t* _vloggerChannel(const char* _Stream);
+
+/**
+ * @brief Records a message without formatting it.
+ *
+ * Only the id of the format string, a timestamp and the raw bytes of the arguments
+ * are stored; strings are copied, everything else is widened to 8 bytes. Formatting
+ * happens when the log is decoded, or on the writer side if the message has to reach
+ * the console or a text stream. Binary streams only echo errors and fatal messages
+ * to the console.
+ *
+ * @param _Stream The output stream to which the record is written.
+ * @param level The log level for the message.
+ * @param fmt_id Per call site storage for the format string id, must start out as 0.
+ * @param message The log message format string, must have static storage duration.
+ * @param ... Variadic arguments of the message.
+ * @note `long double` arguments are stored as `double`, `%n` is ignored.
+ */
+void vloggerLogBinary(const char* _Stream, VLOG_LEVEL level, uint32_t* fmt_id, const char* message, ...);
+
+/**
+ * @brief Decodes a binary log file into text.
+ *
+ * @param path Path of the binary log file.
+ * @param out Where the decoded messages are written.
+ * @return Number of decoded messages, or -1 if the file is missing or not a binary log.
+ */
+long vloggerDecodeFile(const char* path, FILE* out);
+
+/**
+ * @brief Switches the logger to the given mode.
+ *
+ * In `VLOG_MODE_ASYNC` callers only format their message into a slot of a lock-free
+ * multi-producer ring buffer, and a dedicated writer thread drains the ring in batches.
+ * In `VLOG_MODE_PER_THREAD` every thread gets its own single-producer buffer, so callers
+ * never share a cache line, and the writer thread merges the buffers by monotonic
+ * timestamp. A thread that exits leaves its buffer to the next thread that logs,
+ * and vloggerShutdown releases them all. On C11-only platforms without a monotonic
+ * clock (neither TIME_MONOTONIC nor CLOCK_MONOTONIC) the timestamps come from the wall
+ * clock, so ordering across threads is best-effort when the clock is adjusted.
+ * Calling this while a writer thread is already running restarts it with the new settings.
+ *
+ * @param mode The logging mode to switch to.
+ * @param capacity Number of ring buffer slots, or of slots per thread in `VLOG_MODE_PER_THREAD`,
+ * rounded up to a power of two (0 = default).
+ * @return 0 on success, or -1 on failure (the logger stays synchronous).
+ */
+int vloggerStart(VLOG_MODE mode, size_t capacity);
+
+/**
+ * @brief Writes `_Stream` through memory-mapped segment files instead of stdio.
+ *
+ * Segments are named `<_Stream>.<n>`, continuing after the highest index already on disk.
+ * Each one is preallocated to `segment_size` bytes and mapped, and writers reserve space
+ * with an atomic add on its cursor and copy their message in without a lock or a syscall.
+ * A writer that no longer fits rotates to the next segment, and a retired segment is
+ * truncated to the bytes actually written. After a crash the unused tail of the last
+ * segment is left zero filled.
+ *
+ * @note Mapped streams only echo errors and fatal messages to the console, and binary
+ * events sent to them are stored as text. The mapping stays registered for the rest of
+ * the process; vloggerShutdown closes the open segment and the next message opens a new one.
+ *
+ * @param _Stream Stream path to map.
+ * @param segment_size Size of each segment in bytes, rounded up to 64 KiB (0 = `VLOG_MAP_SEGMENT_SIZE`).
+ * @return 0 on success, or -1 if the registry is full or the platform has no mapping support.
+ */
+int vloggerMapStream(const char* _Stream, size_t segment_size);
+
+/**
+ * @brief Blocks until every message logged before the call has been written out
+ * and flushes every open stream file.
+ */
+void vloggerFlush(void);
+
+/**
+ * @brief Flushes pending messages, stops the writer thread, closes every open stream file
+ * and returns to `VLOG_MODE_SYNC`.
+ *
+ * @note Stream files are opened on first use and kept open until this is called.
+ * Errors and fatal messages are flushed right away, everything else is flushed
+ * once `VLOG_SINK_FLUSH_BYTES` are pending or `VLOG_SINK_FLUSH_MS` have passed.
+ * In `VLOG_MODE_SYNC` there is no writer thread, so the time limit is only checked
+ * on the next write to the stream; call `vloggerFlush` to push out idle messages.
+ * @note A stream file that cannot be opened is not kept, every message to it
+ * retries the open and warns on the console if it still fails.
+ * @note In `VLOG_MODE_PER_THREAD` buffers of threads that may still be logging are
+ * freed by those threads once they see the logger stopped, or when they exit.
+ */
+void vloggerShutdown(void);
+
+#if VLOG_BINARY
+// Records a binary message, each call site keeps its own format string id
+#define _VLOG_WRITE(_Stream, _Level, message, ...) do { \
+        static uint32_t __vlog_fmt_id = 0; \
+        vloggerLogBinary(_Stream, _Level, &__vlog_fmt_id, message, ##__VA_ARGS__); \
+    } while (0)
+#else
+#define _VLOG_WRITE(_Stream, _Level, message, ...) _vloggerLog(_Stream, _Level, message, ##__VA_ARGS__)
+#endif
+
+// Checks the runtime threshold of the stream (cached per call site) before touching the arguments
+#define _VLOG_EMIT(_Stream, _Level, message, ...) do { \
+        static vlog_channel_t* volatile __vlog_ch = NULL; \
+        static const void* volatile __vlog_key = NULL; \
+        const char* __vlog_stream = (_Stream); \
+        int __vlog_hit = _VLOG_STREAM_FIXED(_Stream) && VLOG_LOAD_ACQUIRE(&__vlog_key) == __vlog_stream; \
+        vlog_channel_t* __vlog_cur = VLOG_LOAD_ACQUIRE(&__vlog_ch); \
+        if (!__vlog_cur || (!__vlog_hit && !_VLOG_CHANNEL_MATCH(__vlog_cur, __vlog_stream))) { \
+            __vlog_cur = _vloggerChannel(__vlog_stream); \
+            VLOG_STORE_RELEASE(&__vlog_ch, __vlog_cur); \
+            /* The overflow channel is never keyed, so such a stream keeps retrying its lookup */ \
+            if (_VLOG_STREAM_FIXED(_Stream) && __vlog_cur->path) VLOG_STORE_RELEASE(&__vlog_key, __vlog_stream); \
+        } \
+        if ((long)(_Level) <= VLOG_LOAD_RELAXED(&__vlog_cur->level)) { \
+            _VLOG_WRITE(__vlog_stream, _Level, message, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
 /**
  * @brief Logs a fatal-level message.
  *
@@ -64,9 +345,9 @@ void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
  * @param message The log message format string.
  * @param ... Variadic arguments to format the fatal message.
  */
-#define VFATAL(_Stream, message, ...) vloggerLog(_Stream, VLOG_LEVEL_FATAL, message, ##__VA_ARGS__)
+#define VFATAL(_Stream, message, ...) _VLOG_EMIT(_Stream, VLOG_LEVEL_FATAL, message, ##__VA_ARGS__)
 
-#ifndef VERROR
+#if !defined(VERROR) && VLOG_ERROR_ENABLED
 /**
  * @brief Logs an error-level message.
  *
@@ -76,20 +357,26 @@ void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
  * @param message The log message format string.
  * @param ... Variadic arguments to format the error message.
  */
-#define VERROR(_Stream, message, ...) vloggerLog(_Stream, VLOG_LEVEL_ERROR, message, ##__VA_ARGS__)
+#define VERROR(_Stream, message, ...) _VLOG_EMIT(_Stream, VLOG_LEVEL_ERROR, message, ##__VA_ARGS__)
+#elif !defined(VERROR)
+/**
+ * @brief Does nothing if error-level logging is disabled.
+ */
+#define VERROR(_Stream, message, ...)
 #endif
 
 #if VLOG_WARN_ENABLED
 /**
  * @brief Logs a warning-level message.
  *
- * This logs warnings when `VLOG_WARN_ENABLED` is 1.
+ * This logs warnings when `VLOG_WARN_ENABLED` is 1 and the runtime
+ * threshold of the stream allows it.
  *
  * @param _Stream The output stream to which the warning message is written.
  * @param message The log message format string.
  * @param ... Variadic arguments to format the warning message.
  */
-#define VWARN(_Stream, message, ...) vloggerLog(_Stream, VLOG_LEVEL_WARN, message, ##__VA_ARGS__)
+#define VWARN(_Stream, message, ...) _VLOG_EMIT(_Stream, VLOG_LEVEL_WARN, message, ##__VA_ARGS__)
 #else
 /**
  * @brief Does nothing if warning-level logging is disabled.
@@ -101,13 +388,14 @@ void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
 /**
  * @brief Logs an info-level message.
  *
- * This logs informational messages when `VLOG_INFO_ENABLED` is 1.
+ * This logs informational messages when `VLOG_INFO_ENABLED` is 1 and the runtime
+ * threshold of the stream allows it.
  *
  * @param _Stream The output stream to which the info message is written.
  * @param message The log message format string.
  * @param ... Variadic arguments to format the info message.
  */
-#define VINFO(_Stream, message, ...) vloggerLog(_Stream, VLOG_LEVEL_INFO, message, ##__VA_ARGS__)
+#define VINFO(_Stream, message, ...) _VLOG_EMIT(_Stream, VLOG_LEVEL_INFO, message, ##__VA_ARGS__)
 #else
 /**
  * @brief Does nothing if info-level logging is disabled.
@@ -119,13 +407,14 @@ void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
 /**
  * @brief Logs a debug-level message (only enabled in debug builds).
  *
- * This logs debugging information when `VLOG_DEBUG_ENABLED` is 1.
+ * This logs debugging information when `VLOG_DEBUG_ENABLED` is 1 and the runtime
+ * threshold of the stream allows it.
  *
  * @param _Stream The output stream to which the debug message is written.
  * @param message The log message format string.
  * @param ... Variadic arguments to format the debug message.
  */
-#define VDEBUG(_Stream, message, ...) vloggerLog(_Stream, VLOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
+#define VDEBUG(_Stream, message, ...) _VLOG_EMIT(_Stream, VLOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
 #else
 /**
  * @brief Does nothing if debug-level logging is disabled.
@@ -137,13 +426,14 @@ void vloggerLog(const char* _Stream, VLOG_LEVEL level, const char* message, ...)
 /**
  * @brief Logs a trace-level message (only enabled in debug builds).
  *
- * This logs trace-level information when `VLOG_TRACE_ENABLED` is 1.
+ * This logs trace-level information when `VLOG_TRACE_ENABLED` is 1 and the runtime
+ * threshold of the stream allows it.
  *
  * @param _Stream The output stream to which the trace message is written.
  * @param message The log message format string.
  * @param ... Variadic arguments to format the trace message.
  */
-#define VTRACE(_Stream, message, ...) vloggerLog(_Stream, VLOG_LEVEL_TRACE, message, ##__VA_ARGS__)
+#define VTRACE(_Stream, message, ...) _VLOG_EMIT(_Stream, VLOG_LEVEL_TRACE, message, ##__VA_ARGS__)
 #else
 /**
  * @brief Does nothing if trace-level logging is disabled.
@@ -0,0 +1,380 @@
+#include <vmem.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef VSTD_TRACK_ALLOC
+
+static const char* const vmem_names[VSTD_MEM_COUNT] = { "vvec", "vll", "vsk", "vblock" };
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+
+    static size_t mem_add(size_t* value, size_t delta) {
+    #ifdef _WIN64
+        return (size_t)_InterlockedExchangeAdd64((volatile __int64*)value, (__int64)delta) + delta;
+    #else
+        return (size_t)_InterlockedExchangeAdd((volatile long*)value, (long)delta) + delta;
+    #endif
+    }
+
+    static size_t mem_load(size_t* value) { return *(volatile size_t*)value; }
+
+    static int mem_cas(size_t* value, size_t expected, size_t desired) {
+    #ifdef _WIN64
+        return (size_t)_InterlockedCompareExchange64((volatile __int64*)value, (__int64)desired, (__int64)expected) == expected;
+    #else
+        return (size_t)_InterlockedCompareExchange((volatile long*)value, (long)desired, (long)expected) == expected;
+    #endif
+    }
+#else
+    static size_t mem_add(size_t* value, size_t delta) { return __atomic_add_fetch(value, delta, __ATOMIC_RELAXED); }
+    static size_t mem_load(size_t* value) { return __atomic_load_n(value, __ATOMIC_RELAXED); }
+    static int mem_cas(size_t* value, size_t expected, size_t desired) {
+        return __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+#endif
+
+// Sits in front of every tracked block, 16 bytes keep malloc's alignment for the block itself
+typedef union vmem_header_t
+{
+    struct {
+        size_t size;    // Bytes requested by the caller
+        void* raw;      // Start of the underlying malloc block (aligned blocks only)
+    } info;
+    char pad[16];
+} vmem_header_t;
+
+#define VMEM_HEADER(ptr) ((vmem_header_t*)((char*)(ptr) - sizeof(vmem_header_t)))
+
+static vstd_mem_stats_t vmem_stats[VSTD_MEM_COUNT];
+static vstd_mem_hook_fn vmem_hook = NULL;
+static void* vmem_hook_ctx = NULL;
+
+static void vmem_raise_peak(vstd_mem_stats_t* stats, size_t live)
+{
+    size_t peak = mem_load(&stats->peak_bytes);
+    while (live > peak && !mem_cas(&stats->peak_bytes, peak, live)) {
+        peak = mem_load(&stats->peak_bytes);
+    }
+}
+
+static void vmem_on_alloc(VSTD_MEM kind, size_t size)
+{
+    assert(kind < VSTD_MEM_COUNT && "invalid memory kind");
+    vstd_mem_stats_t* stats = &vmem_stats[kind];
+    mem_add(&stats->allocations, 1);
+    vmem_raise_peak(stats, mem_add(&stats->live_bytes, size));
+}
+
+static void vmem_on_free(VSTD_MEM kind, size_t size)
+{
+    assert(kind < VSTD_MEM_COUNT && "invalid memory kind");
+    vstd_mem_stats_t* stats = &vmem_stats[kind];
+    mem_add(&stats->frees, 1);
+    mem_add(&stats->live_bytes, (size_t)0 - size);
+}
+
+static void vmem_on_resize(VSTD_MEM kind, size_t old_size, size_t new_size)
+{
+    assert(kind < VSTD_MEM_COUNT && "invalid memory kind");
+    vstd_mem_stats_t* stats = &vmem_stats[kind];
+    size_t live = mem_add(&stats->live_bytes, new_size - old_size);
+    if (new_size > old_size) {
+        mem_add(&stats->growths, 1);
+        vmem_raise_peak(stats, live);
+
+        vstd_mem_hook_fn hook = vmem_hook;
+        if (hook) hook(kind, old_size, new_size, vmem_hook_ctx);
+    }
+}
+
+void* _vstd_malloc(VSTD_MEM kind, size_t size)
+{
+    vmem_header_t* header = (vmem_header_t*)malloc(sizeof(vmem_header_t) + size);
+    if (!header) return NULL;
+
+    header->info.size = size;
+    header->info.raw = NULL;
+    vmem_on_alloc(kind, size);
+    return header + 1;
+}
+
+void* _vstd_calloc(VSTD_MEM kind, size_t count, size_t size)
+{
+    if (size && count > ((size_t)-1 - sizeof(vmem_header_t)) / size) return NULL;
+
+    void* ptr = _vstd_malloc(kind, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* _vstd_realloc(VSTD_MEM kind, void* ptr, size_t size)
+{
+    if (!ptr) return _vstd_malloc(kind, size);
+    if (!size) {
+        _vstd_free(kind, ptr);
+        return NULL;
+    }
+
+    size_t old_size = VMEM_HEADER(ptr)->info.size;
+    vmem_header_t* header = (vmem_header_t*)realloc(VMEM_HEADER(ptr), sizeof(vmem_header_t) + size);
+    if (!header) return NULL;
+
+    header->info.size = size;
+    vmem_on_resize(kind, old_size, size);
+    return header + 1;
+}
+
+void _vstd_free(VSTD_MEM kind, void* ptr)
+{
+    if (!ptr) return;
+
+    vmem_on_free(kind, VMEM_HEADER(ptr)->info.size);
+    free(VMEM_HEADER(ptr));
+}
+
+// Over-allocates a malloc block so an aligned block with a header in front fits inside
+static void* vmem_aligned_block(size_t size, size_t align)
+{
+    char* raw = (char*)malloc(size + sizeof(vmem_header_t) + align - 1);
+    if (!raw) return NULL;
+
+    uintptr_t start = (uintptr_t)(raw + sizeof(vmem_header_t));
+    char* ptr = raw + ((start + align - 1) & ~(uintptr_t)(align - 1)) - (uintptr_t)raw;
+    VMEM_HEADER(ptr)->info.size = size;
+    VMEM_HEADER(ptr)->info.raw = raw;
+    return ptr;
+}
+
+void* _vstd_aligned_malloc(VSTD_MEM kind, size_t size, size_t align)
+{
+    void* ptr = vmem_aligned_block(size, align);
+    if (ptr) vmem_on_alloc(kind, size);
+    return ptr;
+}
+
+void* _vstd_aligned_realloc(VSTD_MEM kind, void* ptr, size_t size, size_t align)
+{
+    if (!ptr) return _vstd_aligned_malloc(kind, size, align);
+
+    size_t old_size = VMEM_HEADER(ptr)->info.size;
+    void* new_ptr = vmem_aligned_block(size, align);
+    if (!new_ptr) return NULL;
+
+    memcpy(new_ptr, ptr, (old_size < size)? old_size : size);
+    free(VMEM_HEADER(ptr)->info.raw);
+    vmem_on_resize(kind, old_size, size);
+    return new_ptr;
+}
+
+void _vstd_aligned_free(VSTD_MEM kind, void* ptr)
+{
+    if (!ptr) return;
+
+    vmem_on_free(kind, VMEM_HEADER(ptr)->info.size);
+    free(VMEM_HEADER(ptr)->info.raw);
+}
+
+int vstd_mem_stats(VSTD_MEM kind, vstd_mem_stats_t* stats)
+{
+    if (!stats) return -1;
+    memset(stats, 0, sizeof(*stats));
+    if (kind < 0 || kind >= VSTD_MEM_COUNT) return -1;
+
+    vstd_mem_stats_t* src = &vmem_stats[kind];
+    stats->live_bytes = mem_load(&src->live_bytes);
+    stats->peak_bytes = mem_load(&src->peak_bytes);
+    stats->allocations = mem_load(&src->allocations);
+    stats->frees = mem_load(&src->frees);
+    stats->growths = mem_load(&src->growths);
+    return 0;
+}
+
+void vstd_mem_report(void)
+{
+    printf("%-8s %14s %14s %12s %12s %12s\n", "kind", "live bytes", "peak bytes", "allocs", "frees", "growths");
+    for (int kind = 0; kind < VSTD_MEM_COUNT; kind++) {
+        vstd_mem_stats_t stats;
+        vstd_mem_stats((VSTD_MEM)kind, &stats);
+        printf("%-8s %14llu %14llu %12llu %12llu %12llu\n", vmem_names[kind],
+            (unsigned long long)stats.live_bytes, (unsigned long long)stats.peak_bytes,
+            (unsigned long long)stats.allocations, (unsigned long long)stats.frees,
+            (unsigned long long)stats.growths);
+    }
+}
+
+void vstd_mem_reset_peak(void)
+{
+    for (int kind = 0; kind < VSTD_MEM_COUNT; kind++) {
+        vstd_mem_stats_t* stats = &vmem_stats[kind];
+        size_t live = mem_load(&stats->live_bytes);
+        size_t peak = mem_load(&stats->peak_bytes);
+        while (!mem_cas(&stats->peak_bytes, peak, live)) {
+            peak = mem_load(&stats->peak_bytes);
+            live = mem_load(&stats->live_bytes);
+        }
+    }
+}
+
+void vstd_mem_set_hook(vstd_mem_hook_fn hook, void* ctx)
+{
+    vmem_hook_ctx = ctx;
+    vmem_hook = hook;
+}
+
+#else // VSTD_TRACK_ALLOC
+
+int vstd_mem_stats(VSTD_MEM kind, vstd_mem_stats_t* stats)
+{
+    (void)kind;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    return -1;
+}
+
+void vstd_mem_report(void)
+{
+    printf("vstd allocation tracking is off (build with VSTD_TRACK_ALLOC)\n");
+}
+
+void vstd_mem_reset_peak(void)
+{
+}
+
+void vstd_mem_set_hook(vstd_mem_hook_fn hook, void* ctx)
+{
+    (void)hook;
+    (void)ctx;
+}
+
+#endif // VSTD_TRACK_ALLOC
+
+/*
+    Allocators:
+    The heap allocator is special cased by the container side helpers, so its
+    blocks are counted per container kind. Called through its function pointers
+    it is an uncounted malloc.
+*/
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    #include <malloc.h>
+    #define VMEM_WINDOWS 1
+#endif
+
+// On Windows every block comes from the aligned allocator, so one free function fits all of them
+static void* vmem_heap_alloc(void* ctx, size_t size, size_t align)
+{
+    (void)ctx;
+#ifdef VMEM_WINDOWS
+    return _aligned_malloc(size, (align)? align : 16);
+#else
+    if (!align) return malloc(size);
+    void* ptr = NULL;
+    return (posix_memalign(&ptr, align, size) == 0)? ptr : NULL;
+#endif
+}
+
+static void* vmem_heap_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align)
+{
+#ifdef VMEM_WINDOWS
+    (void)ctx; (void)old_size;
+    return _aligned_realloc(ptr, new_size, (align)? align : 16);
+#else
+    if (!align) return realloc(ptr, new_size);
+
+    // POSIX has no aligned realloc
+    void* new_ptr = vmem_heap_alloc(ctx, new_size, align);
+    if (!new_ptr) return NULL;
+    if (ptr) {
+        memcpy(new_ptr, ptr, (old_size < new_size)? old_size : new_size);
+        free(ptr);
+    }
+    return new_ptr;
+#endif
+}
+
+static void vmem_heap_free(void* ctx, void* ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+#ifdef VMEM_WINDOWS
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+static const vallocator_t vmem_heap = { vmem_heap_alloc, vmem_heap_realloc, vmem_heap_free, NULL };
+static const vallocator_t* vmem_default = &vmem_heap;
+
+const vallocator_t* vallocator_heap(void)
+{
+    return &vmem_heap;
+}
+
+const vallocator_t* vallocator_default(void)
+{
+    return vmem_default;
+}
+
+void vallocator_set_default(const vallocator_t* allocator)
+{
+    vmem_default = (allocator)? allocator : &vmem_heap;
+}
+
+const vallocator_t* _vstd_allocator(const vallocator_t* allocator)
+{
+    return (allocator)? allocator : vmem_default;
+}
+
+void* _vstd_alloc(const vallocator_t* allocator, VSTD_MEM kind, size_t size, size_t align)
+{
+    allocator = _vstd_allocator(allocator);
+    if (allocator != &vmem_heap) return allocator->alloc(allocator->ctx, size, align);
+
+#ifdef VSTD_TRACK_ALLOC
+    if (align) return _vstd_aligned_malloc(kind, size, align);
+#else
+    if (align) return vmem_heap_alloc(NULL, size, align);
+#endif
+    (void)kind;
+    return VSTD_MALLOC(kind, size);
+}
+
+void* _vstd_resize(const vallocator_t* allocator, VSTD_MEM kind, void* ptr, size_t old_size, size_t new_size, size_t align)
+{
+    allocator = _vstd_allocator(allocator);
+    if (allocator != &vmem_heap) return allocator->realloc(allocator->ctx, ptr, old_size, new_size, align);
+
+#ifdef VSTD_TRACK_ALLOC
+    if (align) return _vstd_aligned_realloc(kind, ptr, new_size, align);
+#else
+    if (align) return vmem_heap_realloc(NULL, ptr, old_size, new_size, align);
+#endif
+    (void)kind;
+    return VSTD_REALLOC(kind, ptr, new_size);
+}
+
+void _vstd_release(const vallocator_t* allocator, VSTD_MEM kind, void* ptr, size_t size, size_t align)
+{
+    if (!ptr) return;
+
+    allocator = _vstd_allocator(allocator);
+    if (allocator != &vmem_heap) {
+        allocator->free(allocator->ctx, ptr, size);
+        return;
+    }
+
+#ifdef VSTD_TRACK_ALLOC
+    if (align) {
+        _vstd_aligned_free(kind, ptr);
+        return;
+    }
+#else
+    if (align) {
+        vmem_heap_free(NULL, ptr, size);
+        return;
+    }
+#endif
+    (void)kind;
+    VSTD_FREE(kind, ptr);
+}
@@ -0,0 +1,145 @@
+#ifndef __vmem__
+#define __vmem__
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/*
+    Allocation accounting:
+    vvec, vll, vsk and vblock allocate through a vallocator_t. The heap allocator
+    uses the VSTD_MALLOC family below, without VSTD_TRACK_ALLOC these are plain
+    malloc/calloc/realloc/free.
+    With it every block carries a small header holding its size, and each
+    container kind keeps counters that vstd_mem_report prints.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Container kind an allocation is counted under.
+*/
+typedef enum VSTD_MEM /* : int*/
+{
+    VSTD_MEM_VVEC   = 0,  /**< vvec headers, buffers and sort scratch */
+    VSTD_MEM_VLL    = 1,  /**< vll headers and nodes */
+    VSTD_MEM_VSK    = 2,  /**< vsk headers and buffers */
+    VSTD_MEM_VBLOCK = 3,  /**< vblock blocks */
+    VSTD_MEM_COUNT  = 4
+} VSTD_MEM;
+
+/**
+ * @brief Counters of one container kind.
+*/
+typedef struct vstd_mem_stats_t
+{
+    size_t live_bytes;      // Bytes currently allocated
+    size_t peak_bytes;      // Highest value live_bytes reached
+    size_t allocations;     // Number of malloc/calloc calls
+    size_t frees;           // Number of free calls
+    size_t growths;         // Number of reallocs that grew a block
+} vstd_mem_stats_t;
+
+/**
+ * @brief Called after every realloc that grew a block (tracked builds only).
+ *
+ * @param kind Container kind of the block.
+ * @param old_size Size of the block before the realloc.
+ * @param new_size Size of the block after the realloc.
+ * @param ctx User context passed to vstd_mem_set_hook.
+*/
+typedef void (*vstd_mem_hook_fn)(VSTD_MEM kind, size_t old_size, size_t new_size, void* ctx);
+
+/**
+ * @brief Memory source a container allocates from.
+ * Containers keep a pointer to it, so it has to outlive every container created with it.
+*/
+typedef struct vallocator_t
+{
+    void* (*alloc)(void* ctx, size_t size, size_t align);                                  // align 0 = malloc default
+    void* (*realloc)(void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align); // keeps the first min(old_size, new_size) bytes
+    void (*free)(void* ctx, void* ptr, size_t size);
+    void* ctx;                                                                              // Passed to every call
+} vallocator_t;
+
+/**
+ * @brief Returns the built-in allocator backed by malloc (and the platform's aligned allocator).
+*/
+const vallocator_t* vallocator_heap(void);
+
+/**
+ * @brief Returns the allocator containers created without one use.
+*/
+const vallocator_t* vallocator_default(void);
+
+/**
+ * @brief Sets the process wide default allocator, NULL restores vallocator_heap.
+ * Containers keep the allocator they were created with, so change it before creating them.
+*/
+void vallocator_set_default(const vallocator_t* allocator);
+
+/**
+ * @brief Copies the counters of a container kind.
+ *
+ * @param kind Container kind.
+ * @param stats Receives the counters (all 0 without VSTD_TRACK_ALLOC).
+ * @return 0 on success, -1 if `kind` is invalid or tracking is compiled out.
+*/
+int vstd_mem_stats(VSTD_MEM kind, vstd_mem_stats_t* stats);
+
+/**
+ * @brief Prints the counters of every container kind to stdout.
+*/
+void vstd_mem_report(void);
+
+/**
+ * @brief Sets every peak to the current live size, for measuring one phase (a level load) at a time.
+*/
+void vstd_mem_reset_peak(void);
+
+/**
+ * @brief Installs a hook called on every growth event, NULL removes it.
+*/
+void vstd_mem_set_hook(vstd_mem_hook_fn hook, void* ctx);
+
+/*
+    Container side of the allocator interface. `allocator` NULL means vallocator_default,
+    blocks from vallocator_heap are counted under `kind` in tracked builds.
+*/
+const vallocator_t* _vstd_allocator(const vallocator_t* allocator);
+void* _vstd_alloc(const vallocator_t* allocator, VSTD_MEM kind, size_t size, size_t align);
+void* _vstd_resize(const vallocator_t* allocator, VSTD_MEM kind, void* ptr, size_t old_size, size_t new_size, size_t align);
+void _vstd_release(const vallocator_t* allocator, VSTD_MEM kind, void* ptr, size_t size, size_t align);
+
+#ifdef VSTD_TRACK_ALLOC
+
+void* _vstd_malloc(VSTD_MEM kind, size_t size);
+void* _vstd_calloc(VSTD_MEM kind, size_t count, size_t size);
+void* _vstd_realloc(VSTD_MEM kind, void* ptr, size_t size);
+void _vstd_free(VSTD_MEM kind, void* ptr);
+
+// Aligned blocks, used in place of the platform's aligned allocator so the header fits
+void* _vstd_aligned_malloc(VSTD_MEM kind, size_t size, size_t align);
+void* _vstd_aligned_realloc(VSTD_MEM kind, void* ptr, size_t size, size_t align);
+void _vstd_aligned_free(VSTD_MEM kind, void* ptr);
+
+#define VSTD_MALLOC(kind, size) _vstd_malloc(kind, size)
+#define VSTD_CALLOC(kind, count, size) _vstd_calloc(kind, count, size)
+#define VSTD_REALLOC(kind, ptr, size) _vstd_realloc(kind, ptr, size)
+#define VSTD_FREE(kind, ptr) _vstd_free(kind, ptr)
+
+#else
+
+#define VSTD_MALLOC(kind, size) malloc(size)
+#define VSTD_CALLOC(kind, count, size) calloc(count, size)
+#define VSTD_REALLOC(kind, ptr, size) realloc(ptr, size)
+#define VSTD_FREE(kind, ptr) free(ptr)
+
+#endif // VSTD_TRACK_ALLOC
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __vmem__
@@ -0,0 +1,561 @@
+#include <vpool.h>
+#include <vmem.h>
+#include <vdef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static void vpool_worker_run(vpool_t* pool, size_t index);
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    #include <Windows.h>   // Use Windows threading API
+
+    typedef CRITICAL_SECTION pool_mutex_t;
+    typedef CONDITION_VARIABLE pool_cond_t;
+    typedef HANDLE pool_thread_t;
+
+    static void pool_mutex_init(pool_mutex_t* mutex) { InitializeCriticalSection(mutex); }
+    static void pool_mutex_destroy(pool_mutex_t* mutex) { DeleteCriticalSection(mutex); }
+    static void pool_lock(pool_mutex_t* mutex) { EnterCriticalSection(mutex); }
+    static void pool_unlock(pool_mutex_t* mutex) { LeaveCriticalSection(mutex); }
+
+    static void pool_cond_init(pool_cond_t* cond) { InitializeConditionVariable(cond); }
+    static void pool_cond_destroy(pool_cond_t* cond) { (void)cond; }
+    static void pool_cond_wait(pool_cond_t* cond, pool_mutex_t* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+    static void pool_cond_broadcast(pool_cond_t* cond) { WakeAllConditionVariable(cond); }
+
+    typedef struct pool_start_t { vpool_t* pool; size_t index; } pool_start_t;
+
+    static DWORD WINAPI pool_thread_entry(LPVOID arg) {
+        pool_start_t start = *(pool_start_t*)arg;
+        free(arg);
+        vpool_worker_run(start.pool, start.index);
+        return 0;
+    }
+
+    static int pool_thread_start(pool_thread_t* thread, pool_start_t* start) {
+        *thread = CreateThread(NULL, 0, pool_thread_entry, start, 0, NULL);
+        return (*thread)? 0 : -1;
+    }
+
+    static void pool_thread_join(pool_thread_t thread) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    }
+
+    static size_t pool_core_count(void) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (size_t)info.dwNumberOfProcessors;
+    }
+
+    static INIT_ONCE pool_default_once = INIT_ONCE_STATIC_INIT;
+    static void pool_default_init(void);
+
+    static BOOL CALLBACK pool_default_entry(PINIT_ONCE once, PVOID arg, PVOID* ctx) {
+        (void)once; (void)arg; (void)ctx;
+        pool_default_init();
+        return TRUE;
+    }
+
+    static void pool_call_once(void) {
+        InitOnceExecuteOnce(&pool_default_once, pool_default_entry, NULL, NULL);
+    }
+
+#elif defined(__unix__) || defined(__unix) || defined(__APPLE__) || defined(__linux__)
+    #include <pthread.h>    // Use POSIX threads on Unix-based systems
+    #include <unistd.h>
+
+    typedef pthread_mutex_t pool_mutex_t;
+    typedef pthread_cond_t pool_cond_t;
+    typedef pthread_t pool_thread_t;
+
+    static void pool_mutex_init(pool_mutex_t* mutex) { pthread_mutex_init(mutex, NULL); }
+    static void pool_mutex_destroy(pool_mutex_t* mutex) { pthread_mutex_destroy(mutex); }
+    static void pool_lock(pool_mutex_t* mutex) { pthread_mutex_lock(mutex); }
+    static void pool_unlock(pool_mutex_t* mutex) { pthread_mutex_unlock(mutex); }
+
+    static void pool_cond_init(pool_cond_t* cond) { pthread_cond_init(cond, NULL); }
+    static void pool_cond_destroy(pool_cond_t* cond) { pthread_cond_destroy(cond); }
+    static void pool_cond_wait(pool_cond_t* cond, pool_mutex_t* mutex) { pthread_cond_wait(cond, mutex); }
+    static void pool_cond_broadcast(pool_cond_t* cond) { pthread_cond_broadcast(cond); }
+
+    typedef struct pool_start_t { vpool_t* pool; size_t index; } pool_start_t;
+
+    static void* pool_thread_entry(void* arg) {
+        pool_start_t start = *(pool_start_t*)arg;
+        free(arg);
+        vpool_worker_run(start.pool, start.index);
+        return NULL;
+    }
+
+    static int pool_thread_start(pool_thread_t* thread, pool_start_t* start) {
+        return (pthread_create(thread, NULL, pool_thread_entry, start) == 0)? 0 : -1;
+    }
+
+    static void pool_thread_join(pool_thread_t thread) {
+        pthread_join(thread, NULL);
+    }
+
+    static size_t pool_core_count(void) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return (count > 0)? (size_t)count : 1;
+    }
+
+    static pthread_once_t pool_default_once = PTHREAD_ONCE_INIT;
+    static void pool_default_init(void);
+
+    static void pool_call_once(void) {
+        pthread_once(&pool_default_once, pool_default_init);
+    }
+
+#elif defined(__STDC_NO_THREADS__)
+    #error "C11 threads are not supported. Please use a different threading API."
+#else
+    #include <threads.h>
+
+    typedef mtx_t pool_mutex_t;
+    typedef cnd_t pool_cond_t;
+    typedef thrd_t pool_thread_t;
+
+    static void pool_mutex_init(pool_mutex_t* mutex) { mtx_init(mutex, mtx_plain); }
+    static void pool_mutex_destroy(pool_mutex_t* mutex) { mtx_destroy(mutex); }
+    static void pool_lock(pool_mutex_t* mutex) { mtx_lock(mutex); }
+    static void pool_unlock(pool_mutex_t* mutex) { mtx_unlock(mutex); }
+
+    static void pool_cond_init(pool_cond_t* cond) { cnd_init(cond); }
+    static void pool_cond_destroy(pool_cond_t* cond) { cnd_destroy(cond); }
+    static void pool_cond_wait(pool_cond_t* cond, pool_mutex_t* mutex) { cnd_wait(cond, mutex); }
+    static void pool_cond_broadcast(pool_cond_t* cond) { cnd_broadcast(cond); }
+
+    typedef struct pool_start_t { vpool_t* pool; size_t index; } pool_start_t;
+
+    static int pool_thread_entry(void* arg) {
+        pool_start_t start = *(pool_start_t*)arg;
+        free(arg);
+        vpool_worker_run(start.pool, start.index);
+        return 0;
+    }
+
+    static int pool_thread_start(pool_thread_t* thread, pool_start_t* start) {
+        return (thrd_create(thread, pool_thread_entry, start) == thrd_success)? 0 : -1;
+    }
+
+    static void pool_thread_join(pool_thread_t thread) {
+        thrd_join(thread, NULL);
+    }
+
+    static size_t pool_core_count(void) {
+        return 1; // C11 has no way to ask, pass a worker count to vpool_create to use more
+    }
+
+    static once_flag pool_default_once = ONCE_FLAG_INIT;
+    static void pool_default_init(void);
+
+    static void pool_call_once(void) {
+        call_once(&pool_default_once, pool_default_init);
+    }
+
+#endif
+
+/*
+    Work stealing:
+    Each participant (slot 0 is the calling thread, slot i + 1 is worker i) owns
+    a share [lo, hi) of the current range and takes `grain` sized chunks from its
+    front. A participant whose share is empty steals the back half of another
+    share, counted in whole chunks so chunk starts stay on grain boundaries.
+    Shares only change under their slot's lock.
+*/
+typedef struct valign(VPOOL_CACHE_LINE) vpool_slot_t
+{
+    pool_mutex_t lock;
+    size_t lo;                          // Next index of the share
+    size_t hi;                          // End of the share
+} vpool_slot_t;                         // Aligned and sized to whole cache lines, so slots never share one
+
+struct vpool_t
+{
+    pool_mutex_t lock;
+    pool_cond_t wake;                   // Signalled when a job is posted or the pool stops
+    pool_cond_t done;                   // Signalled when the last worker leaves a job
+    pool_thread_t* threads;
+    size_t workers;                     // Number of worker threads
+    vpool_slot_t* slots;                // workers + 1 shares
+    size_t slot_count;                  // Number of allocated slots (one per requested worker + 1)
+
+    // current job
+    vpool_range_fn fn;
+    void* ctx;
+    size_t grain;
+    size_t generation;                  // Bumped for every job
+    size_t active;                      // Workers still inside the current job
+    int busy;                           // 1 while a job runs
+    int stop;                           // 1 once the pool is being destroyed
+};
+
+static vpool_t* vpool_shared = NULL;
+
+// Takes the next chunk of a slot's own share
+static int vpool_take(vpool_slot_t* slot, size_t grain, size_t* begin, size_t* end)
+{
+    int found = 0;
+    pool_lock(&slot->lock);
+    if (slot->lo < slot->hi) {
+        *begin = slot->lo;
+        *end = (slot->hi - slot->lo > grain)? slot->lo + grain : slot->hi;
+        slot->lo = *end;
+        found = 1;
+    }
+    pool_unlock(&slot->lock);
+    return found;
+}
+
+// Moves the back half of another share into `self`'s share, returns 0 if every share is empty
+static int vpool_steal(vpool_t* pool, size_t self)
+{
+    size_t count = pool->workers + 1;
+    for (size_t i = 1; i < count; i++) {
+        vpool_slot_t* victim = &pool->slots[(self + i) % count];
+        size_t lo = 0, hi = 0;
+
+        pool_lock(&victim->lock);
+        if (victim->lo < victim->hi) {
+            size_t chunks = (victim->hi - victim->lo + pool->grain - 1) / pool->grain;
+            lo = victim->lo + (chunks - chunks / 2) * pool->grain;
+            if (lo >= victim->hi) {
+                lo = victim->lo; // A single chunk left, take it whole
+            }
+            hi = victim->hi;
+            victim->hi = lo;
+        }
+        pool_unlock(&victim->lock);
+
+        if (lo < hi) {
+            vpool_slot_t* own = &pool->slots[self];
+            pool_lock(&own->lock);
+            own->lo = lo;
+            own->hi = hi;
+            pool_unlock(&own->lock);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void vpool_work(vpool_t* pool, size_t self)
+{
+    size_t begin = 0, end = 0;
+    for (;;) {
+        if (vpool_take(&pool->slots[self], pool->grain, &begin, &end)) {
+            pool->fn(pool->ctx, begin, end, self);
+        } else if (!vpool_steal(pool, self)) {
+            return;
+        }
+    }
+}
+
+static void vpool_worker_run(vpool_t* pool, size_t index)
+{
+    size_t seen = 0;
+
+    pool_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            pool_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) break;
+        seen = pool->generation;
+        pool_unlock(&pool->lock);
+
+        vpool_work(pool, index + 1);
+
+        pool_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pool_cond_broadcast(&pool->done);
+        }
+    }
+    pool_unlock(&pool->lock);
+}
+
+vpool_t* vpool_create(size_t workers)
+{
+    if (!workers) {
+        size_t cores = pool_core_count();
+        workers = (cores > 1)? cores - 1 : 0;
+    }
+
+    vpool_t* pool = (vpool_t*)calloc(1, sizeof(vpool_t));
+    if (!pool) return NULL;
+
+    pool->threads = (pool_thread_t*)calloc((workers)? workers : 1, sizeof(pool_thread_t));
+    pool->slots = (vpool_slot_t*)vallocator_heap()->alloc(NULL, (workers + 1) * sizeof(vpool_slot_t), VPOOL_CACHE_LINE);
+    if (!pool->threads || !pool->slots) {
+        free(pool->threads);
+        vallocator_heap()->free(NULL, pool->slots, (workers + 1) * sizeof(vpool_slot_t));
+        free(pool);
+        return NULL;
+    }
+    memset(pool->slots, 0, (workers + 1) * sizeof(vpool_slot_t));
+    pool->slot_count = workers + 1;
+
+    pool_mutex_init(&pool->lock);
+    pool_cond_init(&pool->wake);
+    pool_cond_init(&pool->done);
+    for (size_t i = 0; i <= workers; i++) {
+        pool_mutex_init(&pool->slots[i].lock);
+    }
+
+    // Keep whatever threads could be started
+    for (size_t i = 0; i < workers; i++) {
+        pool_start_t* start = (pool_start_t*)malloc(sizeof(pool_start_t));
+        if (start) {
+            start->pool = pool;
+            start->index = i;
+        }
+        if (!start || pool_thread_start(&pool->threads[i], start) == -1) {
+            free(start);
+            break;
+        }
+        pool->workers++;
+    }
+
+    return pool;
+}
+
+static void pool_default_init(void)
+{
+    vpool_shared = vpool_create(0);
+}
+
+vpool_t* vpool_default(void)
+{
+    pool_call_once();
+    return vpool_shared;
+}
+
+size_t vpool_get_workers(vpool_t* pool)
+{
+    if (!pool) return 0;
+    return pool->workers;
+}
+
+int vpool_parallel_range(vpool_t* pool, size_t count, size_t grain, vpool_range_fn fn, void* ctx)
+{
+    if (!fn) return -1;
+    if (!pool) pool = vpool_default();
+    if (!count) return 0;
+
+    size_t participants = (pool)? pool->workers + 1 : 1;
+    if (!grain) {
+        grain = count / (participants * 4);
+        grain = (grain)? grain : 1;
+    }
+
+    int inline_run = (!pool || !pool->workers || count <= grain);
+    if (!inline_run) {
+        pool_lock(&pool->lock);
+        inline_run = pool->busy;
+        pool->busy = 1;
+        pool_unlock(&pool->lock);
+    }
+    if (inline_run) {
+        // No pool, nothing to split or already inside a job: run it here
+        fn(ctx, 0, count, 0);
+        return 0;
+    }
+
+    // Equal shares in whole chunks, so every chunk starts on a grain boundary
+    size_t chunks = (count + grain - 1) / grain;
+    for (size_t i = 0; i < participants; i++) {
+        size_t lo = chunks * i / participants * grain;
+        size_t hi = chunks * (i + 1) / participants * grain;
+        pool->slots[i].lo = (lo < count)? lo : count;
+        pool->slots[i].hi = (hi < count)? hi : count;
+    }
+
+    pool_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->grain = grain;
+    pool->active = pool->workers;
+    pool->generation++;
+    pool_cond_broadcast(&pool->wake);
+    pool_unlock(&pool->lock);
+
+    vpool_work(pool, 0);
+
+    pool_lock(&pool->lock);
+    while (pool->active) {
+        pool_cond_wait(&pool->done, &pool->lock);
+    }
+    pool->busy = 0;
+    pool_unlock(&pool->lock);
+    return 0;
+}
+
+void vpool_destroy(vpool_t** pool)
+{
+    if (pool && *pool)
+    {
+        vpool_t* p = *pool;
+
+        pool_lock(&p->lock);
+        p->stop = 1;
+        pool_cond_broadcast(&p->wake);
+        pool_unlock(&p->lock);
+
+        for (size_t i = 0; i < p->workers; i++) {
+            pool_thread_join(p->threads[i]);
+        }
+        for (size_t i = 0; i < p->slot_count; i++) {
+            pool_mutex_destroy(&p->slots[i].lock);
+        }
+        pool_cond_destroy(&p->done);
+        pool_cond_destroy(&p->wake);
+        pool_mutex_destroy(&p->lock);
+
+        if (p == vpool_shared) {
+            vpool_shared = NULL;
+        }
+        vallocator_heap()->free(NULL, p->slots, p->slot_count * sizeof(vpool_slot_t));
+        free(p->threads);
+        free(p);
+        *pool = NULL;
+    }
+}
+
+/*
+    Parallel vvec loops:
+    The vector is read once through vvec_view and split into chunks of whole
+    cache lines, so two threads never write to the same line of an aligned vector.
+*/
+static size_t vvec_parallel_grain(size_t stride, size_t grain)
+{
+    size_t line = (stride && stride < VPOOL_CACHE_LINE)? VPOOL_CACHE_LINE / stride : 1;
+    return (grain + line - 1) / line * line;
+}
+
+// Automatic grain: a few chunks per participant, whole cache lines each
+static size_t vvec_parallel_auto(vpool_t* pool, size_t count, size_t stride, size_t grain)
+{
+    if (grain) return vvec_parallel_grain(stride, grain);
+
+    size_t participants = (pool)? vpool_get_workers(pool) + 1 : 1;
+    grain = count / (participants * 4);
+    return vvec_parallel_grain(stride, (grain)? grain : 1);
+}
+
+typedef struct vvec_parallel_job_t
+{
+    vvec_view_t src;
+    vvec_view_t dst;
+    void* fn;
+    void* ctx;
+    char* accs;                         // One accumulator per participant (reduce)
+    size_t acc_size;
+} vvec_parallel_job_t;
+
+static void vvec_parallel_for_range(void* ctx, size_t begin, size_t end, size_t worker)
+{
+    vvec_parallel_job_t* job = (vvec_parallel_job_t*)ctx;
+    vvec_parallel_fn fn = (vvec_parallel_fn)job->fn;
+    (void)worker;
+
+    for (size_t i = begin; i < end; i++) {
+        fn(vvec_view_at(job->src, i), i, job->ctx);
+    }
+}
+
+static void vvec_parallel_transform_range(void* ctx, size_t begin, size_t end, size_t worker)
+{
+    vvec_parallel_job_t* job = (vvec_parallel_job_t*)ctx;
+    vvec_transform_fn fn = (vvec_transform_fn)job->fn;
+    (void)worker;
+
+    for (size_t i = begin; i < end; i++) {
+        fn(vvec_view_at(job->dst, i), vvec_view_at(job->src, i), i, job->ctx);
+    }
+}
+
+static void vvec_parallel_reduce_range(void* ctx, size_t begin, size_t end, size_t worker)
+{
+    vvec_parallel_job_t* job = (vvec_parallel_job_t*)ctx;
+    vvec_reduce_fn fn = (vvec_reduce_fn)job->fn;
+    void* acc = job->accs + (worker * job->acc_size);
+
+    for (size_t i = begin; i < end; i++) {
+        fn(acc, vvec_view_at(job->src, i), i, job->ctx);
+    }
+}
+
+int vvec_parallel_for(vvec_t* vec, vvec_parallel_fn fn, void* ctx, size_t grain)
+{
+    if (!vec || !fn) return -1;
+
+    vpool_t* pool = vpool_default();
+    vvec_parallel_job_t job = {0};
+    job.src = vvec_view(vec);
+    job.fn = (void*)fn;
+    job.ctx = ctx;
+
+    grain = vvec_parallel_auto(pool, job.src.size, job.src.stride, grain);
+    return vpool_parallel_range(pool, job.src.size, grain, vvec_parallel_for_range, &job);
+}
+
+int vvec_parallel_transform(vvec_t* dst, vvec_t* src, vvec_transform_fn fn, void* ctx, size_t grain)
+{
+    if (!dst || !src || !fn) return -1;
+
+    size_t length = vvec_get_field(src, VVEC_FIELD_LENGTH);
+    if (dst != src) {
+        vvec_set_field(dst, VVEC_FIELD_LENGTH, length);
+        if (vvec_get_field(dst, VVEC_FIELD_LENGTH) != length) return -1;
+    }
+
+    vpool_t* pool = vpool_default();
+    vvec_parallel_job_t job = {0};
+    job.src = vvec_view(src);
+    job.dst = vvec_view(dst);
+    job.fn = (void*)fn;
+    job.ctx = ctx;
+
+    // Chunks follow the destination's cache lines, it is the side being written
+    grain = vvec_parallel_auto(pool, length, job.dst.stride, grain);
+    return vpool_parallel_range(pool, length, grain, vvec_parallel_transform_range, &job);
+}
+
+int vvec_parallel_reduce(vvec_t* vec, void* result, size_t result_size, const void* identity, vvec_reduce_fn fn, vvec_combine_fn combine, void* ctx, size_t grain)
+{
+    if (!vec || !result || !result_size || !identity || !fn || !combine) return -1;
+
+    vpool_t* pool = vpool_default();
+    size_t participants = (pool)? vpool_get_workers(pool) + 1 : 1;
+
+    // Accumulators on their own cache lines so participants do not share one
+    size_t acc_size = (result_size + VPOOL_CACHE_LINE - 1) / VPOOL_CACHE_LINE * VPOOL_CACHE_LINE;
+    char* accs = (char*)vallocator_heap()->alloc(NULL, participants * acc_size, VPOOL_CACHE_LINE);
+    if (!accs) return -1;
+    for (size_t i = 0; i < participants; i++) {
+        memcpy(accs + (i * acc_size), identity, result_size);
+    }
+
+    vvec_parallel_job_t job = {0};
+    job.src = vvec_view(vec);
+    job.fn = (void*)fn;
+    job.ctx = ctx;
+    job.accs = accs;
+    job.acc_size = acc_size;
+
+    grain = vvec_parallel_auto(pool, job.src.size, job.src.stride, grain);
+    int ret = vpool_parallel_range(pool, job.src.size, grain, vvec_parallel_reduce_range, &job);
+
+    if (ret == 0) {
+        memcpy(result, identity, result_size);
+        for (size_t i = 0; i < participants; i++) {
+            combine(result, accs + (i * acc_size), ctx);
+        }
+    }
+
+    vallocator_heap()->free(NULL, accs, participants * acc_size);
+    return ret;
+}
@@ -0,0 +1,143 @@
+#ifndef __vpool__
+#define __vpool__
+#include <stdint.h>
+#include <stddef.h>
+#include <vvec.h>
+
+//Size of a cache line, parallel vvec loops hand out chunks of whole cache lines
+#ifndef VPOOL_CACHE_LINE
+#define VPOOL_CACHE_LINE 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Work-stealing thread pool handle
+*/
+typedef struct vpool_t vpool_t;
+
+/**
+ * @brief Runs `[begin, end)` of a parallel range.
+ *
+ * @param ctx User context passed to vpool_parallel_range.
+ * @param begin First index of the chunk.
+ * @param end One past the last index of the chunk.
+ * @param worker Index of the thread running the chunk, 0 is the calling thread (below vpool_get_workers(pool) + 1).
+*/
+typedef void (*vpool_range_fn)(void* ctx, size_t begin, size_t end, size_t worker);
+
+/**
+ * @brief Called for each element by vvec_parallel_for.
+*/
+typedef void (*vvec_parallel_fn)(void* item, size_t index, void* ctx);
+
+/**
+ * @brief Called for each element by vvec_parallel_transform, writes the result for `in` to `out`.
+*/
+typedef void (*vvec_transform_fn)(void* out, const void* in, size_t index, void* ctx);
+
+/**
+ * @brief Folds `item` into the accumulator `acc` for vvec_parallel_reduce.
+*/
+typedef void (*vvec_reduce_fn)(void* acc, const void* item, size_t index, void* ctx);
+
+/**
+ * @brief Merges the accumulator `other` into `acc` for vvec_parallel_reduce.
+*/
+typedef void (*vvec_combine_fn)(void* acc, const void* other, void* ctx);
+
+/**
+ * @brief Creates a pool of worker threads.
+ *
+ * @param workers Number of worker threads, the calling thread works as well (0 = one less than the number of cores).
+ * @return Pointer to the newly created pool, or NULL if creation fails.
+*/
+vpool_t* vpool_create(size_t workers);
+
+/**
+ * @brief Returns the process wide pool the vvec_parallel functions use, creating it on first use.
+ *
+ * @return Pointer to the shared pool, or NULL if it could not be created.
+*/
+vpool_t* vpool_default(void);
+
+/**
+ * @brief Returns the number of worker threads of a pool.
+*/
+size_t vpool_get_workers(vpool_t* pool);
+
+/**
+ * @brief Splits `[0, count)` into chunks of `grain` indices and runs them on the pool.
+ *
+ * Every participant starts with an equal share of the range and takes chunks from its front,
+ * a participant that runs dry steals the back half of another one's share.
+ * Returns once every chunk has run. A call made while the pool is busy (for example from
+ * inside `fn`) runs the whole range on the calling thread.
+ *
+ * @param pool Pointer to the pool, or NULL for vpool_default.
+ * @param count Number of indices.
+ * @param grain Indices per chunk (0 = split evenly into a few chunks per participant).
+ * @param fn Function run for each chunk.
+ * @param ctx User context passed to `fn`.
+ * @return 0 on success, or -1 on failure.
+*/
+int vpool_parallel_range(vpool_t* pool, size_t count, size_t grain, vpool_range_fn fn, void* ctx);
+
+/**
+ * @brief Stops the worker threads and frees the pool.
+ *
+ * @param pool Pointer to the pool handle, set to NULL.
+*/
+void vpool_destroy(vpool_t** pool);
+
+/**
+ * @brief Calls `fn` for every element of `vec` on the shared pool.
+ *
+ * @param vec Pointer to the vvec, its size must not change during the call.
+ * @param fn Function called for each element.
+ * @param ctx User context passed to `fn`.
+ * @param grain Elements per chunk, rounded up to whole cache lines (0 = automatic).
+ * @return 0 on success, or -1 on failure.
+*/
+int vvec_parallel_for(vvec_t* vec, vvec_parallel_fn fn, void* ctx, size_t grain);
+
+/**
+ * @brief Writes `fn(src[i])` into `dst[i]` for every element of `src` on the shared pool.
+ * `dst` is resized to the length of `src`, its elements are overwritten in place.
+ * `dst` may be `src`.
+ *
+ * @param dst Pointer to the destination vvec.
+ * @param src Pointer to the source vvec.
+ * @param fn Function called for each element.
+ * @param ctx User context passed to `fn`.
+ * @param grain Elements per chunk, rounded up to whole cache lines (0 = automatic).
+ * @return 0 on success, or -1 on failure.
+*/
+int vvec_parallel_transform(vvec_t* dst, vvec_t* src, vvec_transform_fn fn, void* ctx, size_t grain);
+
+/**
+ * @brief Reduces every element of `vec` into `result` on the shared pool.
+ *
+ * Each participating thread folds its chunks into its own copy of `identity`,
+ * the copies are then combined into `result` in thread order. The order in which
+ * elements meet is not fixed, so `fn` and `combine` should be associative.
+ *
+ * @param vec Pointer to the vvec.
+ * @param result Receives the reduced value (`result_size` bytes).
+ * @param result_size Size of the accumulator.
+ * @param identity Initial value of every accumulator.
+ * @param fn Folds one element into an accumulator.
+ * @param combine Merges two accumulators.
+ * @param ctx User context passed to `fn` and `combine`.
+ * @param grain Elements per chunk, rounded up to whole cache lines (0 = automatic).
+ * @return 0 on success, or -1 on failure.
+*/
+int vvec_parallel_reduce(vvec_t* vec, void* result, size_t result_size, const void* identity, vvec_reduce_fn fn, vvec_combine_fn combine, void* ctx, size_t grain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __vpool__
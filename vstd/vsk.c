@@ -1,4 +1,5 @@
 #include <vsk.h>
+#include <vmem.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -12,6 +13,7 @@ typedef struct vsk_t
     size_t capacity;     // Current capacity
     double scale;        // Resize scale factor
     unsigned char* data; // Stack data(has to be an uchar* becuase cl(msvc) is wierd with pointer math)
+    const vallocator_t* allocator; // Source of the header and the stack data
 } vsk_t;
 
 typedef struct _vsk1_t
@@ -22,6 +24,7 @@ typedef struct _vsk1_t
     size_t capacity;        // Current capacity
     double scale;           // Resize scale factor
     unsigned char* data;    // Stack data(has to be an uchar* becuase cl(msvc) is wierd with pointer math)
+    const vallocator_t* allocator; // Source of the header and the stack data
 
     vsk1_ctor_t  ctor;  // Element Constructor
     vsk1_cctor_t cctor; // Element Copy constructor
@@ -47,9 +50,18 @@ void __def_vsk_dtor(void * self, size_t size)
     }
 }
 
+// Size of the header allocation
+#define _vsk_header_size(sk) (((sk)->ver == VSK_VER_1_0)? sizeof(_vsk1_t) : sizeof(vsk_t))
+
 vsk_t* _vsk_create(size_t stride, size_t initial_capacity, double scale_factor)
+{
+    return _vsk_create_alloc(stride, initial_capacity, scale_factor, NULL);
+}
+
+vsk_t* _vsk_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator)
 {    
-    vsk_t* sk = (vsk_t*)malloc(sizeof(vsk_t));
+    allocator = _vstd_allocator(allocator);
+    vsk_t* sk = (vsk_t*)_vstd_alloc(allocator, VSTD_MEM_VSK, sizeof(vsk_t), 0);
     if (!sk) return NULL;
 
     sk->ver = VSK_VER_0_0;
@@ -57,18 +69,26 @@ vsk_t* _vsk_create(size_t stride, size_t initial_capacity, double scale_factor)
     sk->size = 0;
     sk->capacity = initial_capacity;
     sk->scale = scale_factor;
-    sk->data = (unsigned char*)calloc(initial_capacity, stride);
+    sk->allocator = allocator;
+    sk->data = (unsigned char*)_vstd_alloc(allocator, VSTD_MEM_VSK, initial_capacity * stride, 0);
     if (!sk->data) {
-        free(sk);
+        _vstd_release(allocator, VSTD_MEM_VSK, sk, sizeof(vsk_t), 0);
         return NULL;
     }
+    memset(sk->data, 0, initial_capacity * stride);
 
     return sk;
 }
 
 vsk1_t* _vsk1_create(size_t stride, size_t initial_capacity, double scale_factor, vsk1_ctor_t ctor, vsk1_cctor_t cctor, vsk1_dtor_t dtor)
+{
+    return _vsk1_create_alloc(stride, initial_capacity, scale_factor, NULL, ctor, cctor, dtor);
+}
+
+vsk1_t* _vsk1_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator, vsk1_ctor_t ctor, vsk1_cctor_t cctor, vsk1_dtor_t dtor)
 {    
-    _vsk1_t* sk = (_vsk1_t*)malloc(sizeof(_vsk1_t));
+    allocator = _vstd_allocator(allocator);
+    _vsk1_t* sk = (_vsk1_t*)_vstd_alloc(allocator, VSTD_MEM_VSK, sizeof(_vsk1_t), 0);
     if (!sk) return NULL;
 
     sk->ver = VSK_VER_1_0;
@@ -76,7 +96,8 @@ vsk1_t* _vsk1_create(size_t stride, size_t initial_capacity, double scale_factor
     sk->size = 0;
     sk->capacity = initial_capacity;
     sk->scale = scale_factor;
-    sk->data = (unsigned char*)malloc(initial_capacity * stride);
+    sk->allocator = allocator;
+    sk->data = (unsigned char*)_vstd_alloc(allocator, VSTD_MEM_VSK, initial_capacity * stride, 0);
 
     // version 1.0 stuff
 
@@ -84,7 +105,7 @@ vsk1_t* _vsk1_create(size_t stride, size_t initial_capacity, double scale_factor
     sk->cctor = (cctor)? cctor : __def_vsk_cctor;
     sk->dtor = (dtor)? dtor : __def_vsk_dtor;
     if (!sk->data) {
-        free(sk);
+        _vstd_release(allocator, VSTD_MEM_VSK, sk, sizeof(_vsk1_t), 0);
         return NULL;
     }
 
@@ -116,13 +137,13 @@ size_t vsk_get_field(vsk_t* sk, VSK_FIELD field)
 
 inline int vsk_to_ver(vsk_t* sk, size_t ver){
     if(ver == VSK_VER_1_0){
-        _vsk1_t * new_data = (_vsk1_t *)realloc(sk, sizeof(_vsk1_t));
+        _vsk1_t * new_data = (_vsk1_t *)_vstd_resize(sk->allocator, VSTD_MEM_VSK, sk, _vsk_header_size(sk), sizeof(_vsk1_t), 0);
         new_data->ctor = __def_vsk_ctor;
         new_data->cctor = __def_vsk_cctor;
         new_data->dtor = __def_vsk_dtor;
         if(!new_data) return -1;
     }else{//VSK_VER_0_0
-        vsk_t * new_data = (vsk_t*)realloc(sk, sizeof(vsk_t));
+        vsk_t * new_data = (vsk_t*)_vstd_resize(sk->allocator, VSTD_MEM_VSK, sk, _vsk_header_size(sk), sizeof(vsk_t), 0);
         if(!new_data) return -1;
     }
     return 0;
@@ -131,7 +152,7 @@ inline int vsk_to_ver(vsk_t* sk, size_t ver){
 inline int vsk_resize(vsk_t* sk, size_t new_size) {
     if (new_size > sk->capacity) {
         
-        void* new_data = realloc(sk->data, new_size * sk->stride);
+        void* new_data = _vstd_resize(sk->allocator, VSTD_MEM_VSK, sk->data, sk->capacity * sk->stride, new_size * sk->stride, 0);
         if (!new_data) return -1; 
 
         sk->data = new_data;
@@ -175,7 +196,7 @@ int vsk_scale(vsk_t* sk)
     if (!sk) return -1;
 
     size_t new_capacity = (size_t)(sk->capacity * (1 + sk->scale));
-    unsigned char* new_data = (unsigned char*)realloc(sk->data, new_capacity * sk->stride);
+    unsigned char* new_data = (unsigned char*)_vstd_resize(sk->allocator, VSTD_MEM_VSK, sk->data, sk->capacity * sk->stride, new_capacity * sk->stride, 0);
 
     if (!new_data) return -1;
 
@@ -259,7 +280,6 @@ inline void vsk_pop_NO_CHECK(vsk_t* sk)
     }
 
     sk->size--;
-    sk->capacity++;
 }
 
 void vsk_pop(vsk_t* sk)
@@ -307,6 +327,11 @@ void vsk_swap(vsk_t* lhs, vsk_t* rhs)
 {
     assert(lhs == rhs && "pointers are restricted from pointing to the same address");
     if(lhs->stride != rhs->stride) printf("vsk Warning: stride is not the same size for {lhs} and {rhs} in file: %s line: %d", __FILE__, __LINE__);
+    //each buffer has to go back to the allocator it came from
+    if(lhs->allocator != rhs->allocator) {
+        printf("vsk Warning: {lhs} and {rhs} use different allocators, not swapping in file: %s line: %d", __FILE__, __LINE__);
+        return;
+    }
     //swaping things like meta data and the arrary data pointers
     if(lhs->ver == VSK_VER_1_0 && rhs->ver == VSK_VER_1_0){
         _vsk1_t temp = *(_vsk1_t*)lhs;
@@ -326,8 +351,8 @@ void vsk_destroy(vsk_t** sk)
         while((*sk)->size != 0){
             vsk_pop(*sk);
         }
-        free((*sk)->data);
-        free(*sk);
+        _vstd_release((*sk)->allocator, VSTD_MEM_VSK, (*sk)->data, (*sk)->capacity * (*sk)->stride, 0);
+        _vstd_release((*sk)->allocator, VSTD_MEM_VSK, *sk, _vsk_header_size(*sk), 0);
         *sk = NULL;
     }
 }
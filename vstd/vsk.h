@@ -2,6 +2,7 @@
 #define __vsk__
 #include <stdint.h>
 #include <stdarg.h>
+#include <vmem.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -79,6 +80,22 @@ vsk_t* _vsk_create(size_t stride, size_t initial_capacity, double scale_factor);
  */
 #define vsk_create(T, initial_capacity, scale_factor) (vsk_t*)_vsk_create(sizeof(T), initial_capacity, scale_factor)
 
+/**
+ * @brief Creates a vsk whose header and stack data come from `allocator`.
+ *
+ * @param stride Size of each element in the stack.
+ * @param initial_capacity Initial number of elements the stack can hold.
+ * @param scale_factor Scale factor for dynamic resizing, in percentage.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the stack.
+ * @return Pointer to the newly created vsk, or NULL if creation fails.
+ */
+vsk_t* _vsk_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator);
+
+/**
+ * @brief Creates a vsk of type T that allocates from `allocator`.
+ */
+#define vsk_create_alloc(T, initial_capacity, scale_factor, allocator) (vsk_t*)_vsk_create_alloc(sizeof(T), initial_capacity, scale_factor, allocator)
+
 /**
  * @brief Creates a vsk with the specified element stride, initial capacity, and scale factor.
  *
@@ -92,6 +109,25 @@ vsk_t* _vsk_create(size_t stride, size_t initial_capacity, double scale_factor);
  */
 vsk1_t* _vsk1_create(size_t stride, size_t initial_capacity, double scale_factor, vsk1_ctor_t ctor, vsk1_cctor_t cctor, vsk1_dtor_t dtor);
 
+/**
+ * @brief Creates a vsk1 whose header and stack data come from `allocator`.
+ *
+ * @param stride Size of each element in the stack.
+ * @param initial_capacity Initial number of elements the stack can hold.
+ * @param scale_factor Scale factor for dynamic resizing, in percentage.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the stack.
+ * @param ctor Constructor function to be called for when a stack is element is created, or NULL if default.
+ * @param cctor Copy constructor function to be called for when a stack is element is created, or NULL if default.
+ * @param dtor Destructor function to be called for each element when the stack is destroyed, or NULL if default.
+ * @return Pointer to the newly created vsk, or NULL if creation fails.
+ */
+vsk1_t* _vsk1_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator, vsk1_ctor_t ctor, vsk1_cctor_t cctor, vsk1_dtor_t dtor);
+
+/**
+ * @brief Creates a vsk1 of type T that allocates from `allocator`.
+ */
+#define vsk1_create_alloc(T, initial_capacity, scale_factor, allocator, ctor, cctor, dtor) (vsk1_t*)_vsk1_create_alloc(sizeof(T), initial_capacity, scale_factor, allocator, ctor, cctor, dtor)
+
 /**
  * @brief Creates a vsk with the specified element stride, initial capacity, and scale factor.
  *
@@ -0,0 +1,188 @@
+#include <vslotmap.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Entry of the slot table
+typedef struct vslot_t
+{
+    uint32_t dense;         // Index into the packed storage, or the next free slot while free
+    uint32_t generation;    // Odd while occupied, bumped on every insert and remove
+} vslot_t;
+
+struct vslotmap_t
+{
+    vvec1_t* items;         // Packed elements
+    vvec_t* owners;         // Slot of each packed element (uint32_t)
+    vvec_t* slots;          // Slot table (vslot_t)
+    uint32_t free_head;     // First free slot, VSLOT_NONE if the table is full
+    const vallocator_t* allocator; // Source of the header and of the three vectors
+};
+
+vslotmap_t* _vslotmap_create(size_t stride, size_t initial_capacity, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
+    return _vslotmap_create_alloc(stride, initial_capacity, NULL, ctor, cctor, dtor);
+}
+
+vslotmap_t* _vslotmap_create_alloc(size_t stride, size_t initial_capacity, const vallocator_t* allocator, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
+    allocator = _vstd_allocator(allocator);
+    vslotmap_t* map = (vslotmap_t*)_vstd_alloc(allocator, VSTD_MEM_VVEC, sizeof(vslotmap_t), 0);
+    if (!map) return NULL;
+    memset(map, 0, sizeof(vslotmap_t));
+    map->allocator = allocator;
+
+    size_t capacity = (initial_capacity)? initial_capacity : 1;
+    map->items = _vvec1_create_alloc(stride, capacity, 0.5, allocator, ctor, cctor, dtor);
+    map->owners = vvec_create_alloc(uint32_t, capacity, 0.5, allocator);
+    map->slots = vvec_create_alloc(vslot_t, capacity, 0.5, allocator);
+    map->free_head = VSLOT_NONE;
+
+    if (!map->items || !map->owners || !map->slots) {
+        vslotmap_destroy(&map);
+        return NULL;
+    }
+    return map;
+}
+
+// Returns the slot of a live handle, or NULL if the handle is stale
+static vslot_t* _vslotmap_slot(vslotmap_t* map, vslot_handle_t handle)
+{
+    if (!map || !(handle.generation & 1)) return NULL;
+
+    vvec_view_t slots = vvec_view(map->slots);
+    if (handle.index >= slots.size) return NULL;
+
+    vslot_t* slot = vvec_view_as(vslot_t, slots) + handle.index;
+    return (slot->generation == handle.generation)? slot : NULL;
+}
+
+vslot_handle_t vslotmap_insert(vslotmap_t* map, const void* original)
+{
+    if (!map) return VSLOT_HANDLE_NULL;
+
+    size_t dense = vvec_get_field(map->items, VVEC_FIELD_LENGTH);
+    if (dense >= VSLOT_NONE) return VSLOT_HANDLE_NULL;
+
+    // Take a free slot, or append one
+    uint32_t index = map->free_head;
+    if (index == VSLOT_NONE) {
+        size_t count = vvec_get_field(map->slots, VVEC_FIELD_LENGTH);
+        if (count >= VSLOT_NONE) return VSLOT_HANDLE_NULL;
+
+        vslot_t slot = { VSLOT_NONE, 0 };
+        if (vvec_push_back(map->slots, &slot) != 0) return VSLOT_HANDLE_NULL;
+        index = (uint32_t)count;
+        map->free_head = index;
+    }
+
+    // Construct the element before touching the free list, so a failure changes nothing
+    if (original) {
+        if (vvec_push_back(map->items, original) != 0) return VSLOT_HANDLE_NULL;
+    } else {
+        vvec_set_field(map->items, VVEC_FIELD_LENGTH, dense + 1);
+        if (vvec_get_field(map->items, VVEC_FIELD_LENGTH) != dense + 1) return VSLOT_HANDLE_NULL;
+    }
+
+    uint32_t owner = index;
+    if (vvec_push_back(map->owners, &owner) != 0) {
+        vvec_pop_at(map->items, VVEC_BACK);
+        return VSLOT_HANDLE_NULL;
+    }
+
+    vslot_t* slot = (vslot_t*)vvec_at(map->slots, index);
+    map->free_head = slot->dense;
+    slot->dense = (uint32_t)dense;
+    slot->generation++;
+
+    vslot_handle_t handle = { index, slot->generation };
+    return handle;
+}
+
+int vslotmap_remove(vslotmap_t* map, vslot_handle_t handle)
+{
+    vslot_t* slot = _vslotmap_slot(map, handle);
+    if (!slot) return -1;
+
+    size_t dense = slot->dense;
+
+    // The last element moves into the gap, its slot has to follow
+    vvec_swap_remove(map->items, (ssize_t)dense);
+    vvec_swap_remove(map->owners, (ssize_t)dense);
+    if (dense < vslotmap_size(map)) {
+        uint32_t owner = *(uint32_t*)vvec_at(map->owners, (ssize_t)dense);
+        ((vslot_t*)vvec_at(map->slots, owner))->dense = (uint32_t)dense;
+    }
+
+    slot->generation++;
+    slot->dense = map->free_head;
+    map->free_head = handle.index;
+    return 0;
+}
+
+void* vslotmap_get(vslotmap_t* map, vslot_handle_t handle)
+{
+    vslot_t* slot = _vslotmap_slot(map, handle);
+    if (!slot) return NULL;
+    return vvec_view_at(vvec_view(map->items), slot->dense);
+}
+
+int vslotmap_contains(vslotmap_t* map, vslot_handle_t handle)
+{
+    return _vslotmap_slot(map, handle) != NULL;
+}
+
+size_t vslotmap_size(vslotmap_t* map)
+{
+    if (!map) return 0;
+    return vvec_get_field(map->items, VVEC_FIELD_LENGTH);
+}
+
+vvec_view_t vslotmap_view(vslotmap_t* map)
+{
+    if (!map) {
+        vvec_view_t view = { NULL, 0, 0 };
+        return view;
+    }
+    return vvec_view(map->items);
+}
+
+vslot_handle_t vslotmap_handle_at(vslotmap_t* map, size_t index)
+{
+    if (!map) return VSLOT_HANDLE_NULL;
+
+    vvec_view_t owners = vvec_view(map->owners);
+    assert(index < owners.size && "index out-of-range");
+
+    uint32_t slot = vvec_view_as(uint32_t, owners)[index];
+    vslot_handle_t handle = { slot, ((vslot_t*)vvec_at(map->slots, slot))->generation };
+    return handle;
+}
+
+void vslotmap_clear(vslotmap_t* map)
+{
+    if (!map) return;
+
+    vvec_view_t owners = vvec_view(map->owners);
+    for (size_t i = 0; i < owners.size; i++) {
+        uint32_t index = vvec_view_as(uint32_t, owners)[i];
+        vslot_t* slot = (vslot_t*)vvec_at(map->slots, index);
+        slot->generation++;
+        slot->dense = map->free_head;
+        map->free_head = index;
+    }
+    vvec_clear(map->items);
+    vvec_clear(map->owners);
+}
+
+void vslotmap_destroy(vslotmap_t** map)
+{
+    if (map && *map)
+    {
+        vvec_destroy(&(*map)->items);
+        vvec_destroy(&(*map)->owners);
+        vvec_destroy(&(*map)->slots);
+        _vstd_release((*map)->allocator, VSTD_MEM_VVEC, *map, sizeof(vslotmap_t), 0);
+        *map = NULL;
+    }
+}
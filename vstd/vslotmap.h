@@ -0,0 +1,167 @@
+#ifndef __vslotmap__
+#define __vslotmap__
+#include <stdint.h>
+#include <vvec.h>
+
+//Index of a handle that refers to nothing
+#define VSLOT_NONE UINT32_MAX
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Slot map handle
+ * Elements live packed in a vvec1, handles point at them through a slot table,
+ * so handles stay valid while the elements move around.
+*/
+typedef struct vslotmap_t vslotmap_t;
+
+/**
+ * @brief Stable reference to an element of a vslotmap.
+ * A handle goes stale once its element is removed, even if the slot is reused.
+*/
+typedef struct vslot_handle_t
+{
+    uint32_t index;         // Slot in the slot table
+    uint32_t generation;    // Generation of the slot when the handle was made (odd while occupied)
+} vslot_handle_t;
+
+/**
+ * @brief Handle that never refers to an element.
+*/
+#define VSLOT_HANDLE_NULL ((vslot_handle_t){ VSLOT_NONE, 0 })
+
+/**
+ * @brief Creates a slot map with the specified element stride, initial capacity and element callbacks.
+ *
+ * @param stride Size of each element.
+ * @param initial_capacity Initial number of elements the map can hold.
+ * @param ctor Element constructor (NULL = zero fill / copy).
+ * @param cctor Element copy constructor (NULL = memcpy).
+ * @param dtor Element destructor (NULL = none).
+ * @return Pointer to the newly created slot map, or NULL if creation fails.
+*/
+vslotmap_t* _vslotmap_create(size_t stride, size_t initial_capacity, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor);
+
+/**
+ * @brief Creates a slot map of `T` elements.
+ *
+ * @param T Element type.
+ * @param initial_capacity Initial number of elements the map can hold.
+ * @param ctor Element constructor (NULL = zero fill / copy).
+ * @param cctor Element copy constructor (NULL = memcpy).
+ * @param dtor Element destructor (NULL = none).
+ * @return Pointer to the newly created slot map, or NULL if creation fails.
+*/
+#define vslotmap_create(T, initial_capacity, ctor, cctor, dtor) _vslotmap_create(sizeof(T), initial_capacity, ctor, cctor, dtor)
+
+/**
+ * @brief Creates a slot map whose header and storage come from `allocator`.
+ *
+ * @param stride Size of each element.
+ * @param initial_capacity Initial number of elements the map can hold.
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the map.
+ * @param ctor Element constructor (NULL = zero fill / copy).
+ * @param cctor Element copy constructor (NULL = memcpy).
+ * @param dtor Element destructor (NULL = none).
+ * @return Pointer to the newly created slot map, or NULL if creation fails.
+*/
+vslotmap_t* _vslotmap_create_alloc(size_t stride, size_t initial_capacity, const vallocator_t* allocator, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor);
+
+/**
+ * @brief Creates a slot map of `T` elements that allocates from `allocator`.
+*/
+#define vslotmap_create_alloc(T, initial_capacity, allocator, ctor, cctor, dtor) _vslotmap_create_alloc(sizeof(T), initial_capacity, allocator, ctor, cctor, dtor)
+
+/**
+ * @brief Copy constructs an element at the end of the packed storage.
+ *
+ * @param map Pointer to the slot map.
+ * @param original Pointer to the element to copy, or NULL to default construct one.
+ * @return Handle of the new element, or VSLOT_HANDLE_NULL on failure.
+*/
+vslot_handle_t vslotmap_insert(vslotmap_t* map, const void* original);
+
+/**
+ * @brief Destroys the element of `handle`. The last element is moved into its place.
+ *
+ * @param map Pointer to the slot map.
+ * @param handle Handle of the element.
+ * @return 0 on success, or -1 if the handle is stale.
+*/
+int vslotmap_remove(vslotmap_t* map, vslot_handle_t handle);
+
+/**
+ * @brief Returns a pointer to the element of `handle`.
+ * The pointer is invalidated by the next insert or remove, the handle is not.
+ *
+ * @param map Pointer to the slot map.
+ * @param handle Handle of the element.
+ * @return Pointer to the element, or NULL if the handle is stale.
+*/
+void* vslotmap_get(vslotmap_t* map, vslot_handle_t handle);
+
+/**
+ * @brief Returns 1 if `handle` refers to an element of the map, else 0.
+*/
+int vslotmap_contains(vslotmap_t* map, vslot_handle_t handle);
+
+/**
+ * @brief Returns the number of elements in the map.
+*/
+size_t vslotmap_size(vslotmap_t* map);
+
+/**
+ * @brief Takes a view of the packed elements, iterate it like a vvec.
+ * The order changes when elements are removed.
+ *
+ * @param map Pointer to the slot map.
+ * @return View of the elements, empty if `map` is NULL.
+*/
+vvec_view_t vslotmap_view(vslotmap_t* map);
+
+/**
+ * @brief Returns the handle of the element at `index` of the packed storage.
+ *
+ * @param map Pointer to the slot map.
+ * @param index Index into vslotmap_view, must be below the map's size.
+*/
+vslot_handle_t vslotmap_handle_at(vslotmap_t* map, size_t index);
+
+/**
+ * @brief Destroys every element. Outstanding handles go stale.
+ *
+ * @param map Pointer to the slot map.
+*/
+void vslotmap_clear(vslotmap_t* map);
+
+/**
+ * @brief Destroys the slot map and frees associated memory.
+ *
+ * @param map Pointer to the slot map handle, set to NULL.
+*/
+void vslotmap_destroy(vslotmap_t** map);
+
+/**
+ * Macro to iterate over the elements of a vslotmap
+ * @param T Type of the element
+ * @param item A `T*` that will point at each element
+ * @param handle A vslot_handle_t that will hold each element's handle
+ * @param map The vslotmap to iterate over
+ * @param action The action to perform on each iteration, must not insert or remove
+*/
+#define vslotmap_foreach(T, item, handle, map, action) do { \
+    vvec_view_t __view = vslotmap_view(map); \
+    for (size_t __index = 0; __index < __view.size; __index++) { \
+        T* item = (T*)vvec_view_at(__view, __index); \
+        vslot_handle_t handle = vslotmap_handle_at(map, __index); \
+        action \
+    }\
+} while(0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __vslotmap__
@@ -1,4 +1,5 @@
 #include <vvec.h>
+#include <vmem.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -12,6 +13,10 @@ typedef struct vvec_t
     size_t capacity;     // Current capacity
     double scale;        // Resize scale factor
     char* data; // vector data(has to be an uchar* becuase cl(msvc) is wierd with pointer math)
+    size_t inline_capacity; // Number of items that fit in the storage after the header
+    size_t growth_page;     // Large buffers grow in steps of this many bytes (0 = off)
+    size_t align;           // Alignment of `data` in bytes (0 = whatever malloc gives)
+    const vallocator_t* allocator; // Source of the header and every buffer
 } vvec_t;
 
 typedef struct _vvec1_t
@@ -22,16 +27,24 @@ typedef struct _vvec1_t
     size_t capacity;        // Current capacity
     double scale;           // Resize scale factor
     char* data;    // vector data(has to be an uchar* becuase cl(msvc) is wierd with pointer math)
+    size_t inline_capacity; // Number of items that fit in the storage after the header
+    size_t growth_page;     // Large buffers grow in steps of this many bytes (0 = off)
+    size_t align;           // Alignment of `data` in bytes (0 = whatever malloc gives)
+    const vallocator_t* allocator; // Source of the header and every buffer
 
     // version 1.0 stuff
 
     vvec1_ctor_t  ctor;  // Element Constructor
     vvec1_cctor_t cctor; // Element Copy constructor
     vvec1_dtor_t  dtor;  // Element Destructor
+    size_t trivial;      // 1 if elements are copied with memcpy and need no destructor
 } _vvec1_t;
 
 int __def_vvec_ctor(void * self, size_t size, va_list args, size_t count) { 
-    if(!count) memcpy(self, 0, size);
+    if(!count) {
+        memset(self, 0, size);
+        return 0;
+    }
     void *arg = va_arg(args, void *);
     memcpy(self, arg, size);
     return 0;
@@ -50,50 +63,272 @@ void __def_vvec_dtor(void * self, size_t size)
     }
 }
 
-vvec_t* _vvec_create(size_t stride, size_t initial_capacity, double scale_factor)
-{    
-    vvec_t* vec = (vvec_t*)malloc(sizeof(vvec_t));
+// Inline storage starts after the header, rounded up so any element type is aligned
+#define VVEC_INLINE_OFFSET(header) ((sizeof(header) + 15) & ~(size_t)15)
+
+// Returns the inline storage of `vec`, or NULL if it was created without one
+static char* _vvec_inline_data(vvec_t* vec)
+{
+    if (!vec->inline_capacity) return NULL;
+    return (char*)vec + ((vec->ver == VVEC_VER_1_0)? VVEC_INLINE_OFFSET(_vvec1_t) : VVEC_INLINE_OFFSET(vvec_t));
+}
+
+/*
+    Heap buffers:
+    Every buffer comes from the vector's allocator with the vector's alignment,
+    and goes back to it with the size it was allocated with.
+*/
+static char* _vvec_data_alloc(vvec_t* vec, size_t bytes)
+{
+    return (char*)_vstd_alloc(vec->allocator, VSTD_MEM_VVEC, bytes, vec->align);
+}
+
+static void _vvec_data_free(vvec_t* vec, char* data, size_t bytes)
+{
+    _vstd_release(vec->allocator, VSTD_MEM_VVEC, data, bytes, vec->align);
+}
+
+// Resizes a heap buffer of `old_bytes` to `bytes`
+static char* _vvec_data_realloc(vvec_t* vec, char* data, size_t old_bytes, size_t bytes)
+{
+    return (char*)_vstd_resize(vec->allocator, VSTD_MEM_VVEC, data, old_bytes, bytes, vec->align);
+}
+
+// Size of the heap buffer holding `capacity` items, aligned buffers are rounded up to whole multiples of the alignment
+static size_t _vvec_data_bytes(vvec_t* vec, size_t capacity)
+{
+    size_t bytes = (capacity)? capacity * vec->stride : 1;
+    if (vec->align) {
+        bytes = (bytes + vec->align - 1) & ~(vec->align - 1);
+    }
+    return bytes;
+}
+
+// Alignments have to be powers of two the aligned allocators accept
+static int _vvec_valid_align(size_t align)
+{
+    return align == 0 || (align >= sizeof(void*) && (align & (align - 1)) == 0);
+}
+
+// Allocates a header of `header_size` bytes followed by room for `inline_capacity` items
+static vvec_t* _vvec_alloc(size_t header_size, size_t ver, size_t stride, size_t capacity, double scale_factor, size_t inline_capacity, size_t align, const vallocator_t* allocator)
+{
+    if (!_vvec_valid_align(align)) return NULL;
+
+    allocator = _vstd_allocator(allocator);
+    vvec_t* vec = (vvec_t*)_vstd_alloc(allocator, VSTD_MEM_VVEC, header_size + inline_capacity * stride, 0);
     if (!vec) return NULL;
 
-    vec->ver = VVEC_VER_0_0;
+    vec->ver = ver;
     vec->stride = stride;
     vec->size = 0;
-    vec->capacity = initial_capacity;
     vec->scale = (scale_factor)? scale_factor : 0.5;
-    vec->data = (unsigned char*)calloc(initial_capacity, stride);
+    vec->inline_capacity = inline_capacity;
+    vec->growth_page = VVEC_GROWTH_PAGE;
+    vec->align = align;
+    vec->allocator = allocator;
+
+    if (inline_capacity) {
+        vec->capacity = inline_capacity;
+        vec->data = _vvec_inline_data(vec);
+        return vec;
+    }
+
+    vec->capacity = capacity;
+    vec->data = _vvec_data_alloc(vec, _vvec_data_bytes(vec, capacity));
     if (!vec->data) {
-        free(vec);
+        _vstd_release(allocator, VSTD_MEM_VVEC, vec, header_size, 0);
         return NULL;
     }
-
     return vec;
 }
 
-vvec1_t* _vvec1_create(size_t stride, size_t initial_capacity, double scale_factor, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
-{    
-    _vvec1_t* vec = (_vvec1_t*)malloc(sizeof(_vvec1_t));
-    if (!vec) return NULL;
-
-    vec->ver = VVEC_VER_1_0;
-    vec->stride = stride;
-    vec->size = 0;
-    vec->capacity = initial_capacity;
-    vec->scale = (scale_factor)? scale_factor : 0.5;
-    vec->data = (unsigned char*)malloc(initial_capacity * stride);
+// Size of the header allocation, including the inline storage
+static size_t _vvec_header_bytes(vvec_t* vec)
+{
+    if (vec->inline_capacity) {
+        size_t offset = (vec->ver == VVEC_VER_1_0)? VVEC_INLINE_OFFSET(_vvec1_t) : VVEC_INLINE_OFFSET(vvec_t);
+        return offset + vec->inline_capacity * vec->stride;
+    }
+    return (vec->ver == VVEC_VER_1_0)? sizeof(_vvec1_t) : sizeof(vvec_t);
+}
 
-    // version 1.0 stuff
+// Elements only count as trivial when nothing but the default callbacks touch them
+static size_t _vvec1_defaults(_vvec1_t* vec)
+{
+    return vec->ctor == __def_vvec_ctor && vec->cctor == __def_vvec_cctor && vec->dtor == __def_vvec_dtor;
+}
 
+static void _vvec1_init(_vvec1_t* vec, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
     vec->ctor = (ctor)? ctor : __def_vvec_ctor;
     vec->cctor = (cctor)? cctor : __def_vvec_cctor;
     vec->dtor = (dtor)? dtor : __def_vvec_dtor;
-    if (!vec->data) {
-        free(vec);
-        return NULL;
+    vec->trivial = _vvec1_defaults(vec);
+}
+
+// Version 0.0 vectors always use the default callbacks
+static int _vvec_is_trivial(vvec_t* vec)
+{
+    return vec->ver == VVEC_VER_0_0 || ((_vvec1_t*)vec)->trivial;
+}
+
+// Destroys the items in [first, last), trivial items need nothing
+static void _vvec_destroy_range(vvec_t* vec, size_t first, size_t last)
+{
+    if (_vvec_is_trivial(vec)) return;
+
+    vvec1_dtor_t dtor = ((_vvec1_t*)vec)->dtor;
+    for (size_t i = first; i < last; i++) {
+        dtor(vec->data + (i * vec->stride), vec->stride);
+    }
+}
+
+// Copy constructs one item, trivial items are a plain memcpy
+static int _vvec_copy_item(vvec_t* vec, void* self, const void* original)
+{
+    if (_vvec_is_trivial(vec)) {
+        memcpy(self, original, vec->stride);
+        return 0;
     }
+    return ((_vvec1_t*)vec)->cctor(self, original, vec->stride);
+}
+
+vvec_t* _vvec_create(size_t stride, size_t initial_capacity, double scale_factor)
+{
+    return _vvec_alloc(sizeof(vvec_t), VVEC_VER_0_0, stride, initial_capacity, scale_factor, 0, 0, NULL);
+}
+
+vvec_t* _vvec_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator)
+{
+    return _vvec_alloc(sizeof(vvec_t), VVEC_VER_0_0, stride, initial_capacity, scale_factor, 0, 0, allocator);
+}
+
+vvec_t* _vvec_create_inline(size_t stride, size_t inline_capacity, double scale_factor)
+{
+    return _vvec_alloc(VVEC_INLINE_OFFSET(vvec_t), VVEC_VER_0_0, stride, 0, scale_factor, inline_capacity, 0, NULL);
+}
+
+vvec_t* _vvec_create_aligned(size_t stride, size_t initial_capacity, double scale_factor, size_t alignment)
+{
+    return _vvec_alloc(sizeof(vvec_t), VVEC_VER_0_0, stride, initial_capacity, scale_factor, 0, alignment, NULL);
+}
+
+vvec1_t* _vvec1_create(size_t stride, size_t initial_capacity, double scale_factor, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
+    return _vvec1_create_alloc(stride, initial_capacity, scale_factor, NULL, ctor, cctor, dtor);
+}
+
+vvec1_t* _vvec1_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
+    _vvec1_t* vec = (_vvec1_t*)_vvec_alloc(sizeof(_vvec1_t), VVEC_VER_1_0, stride, initial_capacity, scale_factor, 0, 0, allocator);
+    if (!vec) return NULL;
+
+    // version 1.0 stuff
+    _vvec1_init(vec, ctor, cctor, dtor);
+    return (vvec1_t*)vec;
+}
+
+vvec1_t* _vvec1_create_aligned(size_t stride, size_t initial_capacity, double scale_factor, size_t alignment, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
+    _vvec1_t* vec = (_vvec1_t*)_vvec_alloc(sizeof(_vvec1_t), VVEC_VER_1_0, stride, initial_capacity, scale_factor, 0, alignment, NULL);
+    if (!vec) return NULL;
 
+    _vvec1_init(vec, ctor, cctor, dtor);
     return (vvec1_t*)vec;
 }
 
+vvec1_t* _vvec1_create_inline(size_t stride, size_t inline_capacity, double scale_factor, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor)
+{
+    _vvec1_t* vec = (_vvec1_t*)_vvec_alloc(VVEC_INLINE_OFFSET(_vvec1_t), VVEC_VER_1_0, stride, 0, scale_factor, inline_capacity, 0, NULL);
+    if (!vec) return NULL;
+
+    _vvec1_init(vec, ctor, cctor, dtor);
+    return (vvec1_t*)vec;
+}
+
+/*
+    Moves the items into storage for `new_capacity` items. Vectors with inline
+    storage move back into it whenever the items fit (unless they are aligned),
+    and the inline buffer itself is never passed to realloc or free. Aligned
+    buffers are rounded up to whole multiples of the alignment, so no two
+    vectors share the last aligned block.
+*/
+static int _vvec_realloc_data(vvec_t* vec, size_t new_capacity)
+{
+    char* inline_data = _vvec_inline_data(vec);
+    size_t used = vec->size * vec->stride;
+
+    if (inline_data && !vec->align && new_capacity <= vec->inline_capacity) {
+        if (vec->data != inline_data) {
+            memcpy(inline_data, vec->data, used);
+            _vvec_data_free(vec, vec->data, _vvec_data_bytes(vec, vec->capacity));
+            vec->data = inline_data;
+        }
+        vec->capacity = vec->inline_capacity;
+        return 0;
+    }
+
+    size_t bytes = _vvec_data_bytes(vec, new_capacity);
+
+    char* new_data = NULL;
+    if (vec->data == inline_data) {
+        new_data = _vvec_data_alloc(vec, bytes);
+        if (!new_data) return -1;
+        memcpy(new_data, inline_data, used);
+    } else {
+        new_data = _vvec_data_realloc(vec, vec->data, _vvec_data_bytes(vec, vec->capacity), bytes);
+        if (!new_data) return -1;
+    }
+
+    vec->data = new_data;
+    vec->capacity = new_capacity;
+    return 0;
+}
+
+// Moves the items into a buffer with the new alignment
+static int _vvec_realign(vvec_t* vec, size_t align)
+{
+    if (!_vvec_valid_align(align)) return -1;
+    if (align == vec->align) return 0;
+
+    vvec_t target = *vec;
+    target.align = align;
+
+    char* new_data = _vvec_data_alloc(&target, _vvec_data_bytes(&target, vec->capacity));
+    if (!new_data) return -1;
+
+    memcpy(new_data, vec->data, vec->size * vec->stride);
+    if (vec->data != _vvec_inline_data(vec)) {
+        _vvec_data_free(vec, vec->data, _vvec_data_bytes(vec, vec->capacity));
+    }
+    vec->data = new_data;
+    vec->align = align;
+    return 0;
+}
+
+size_t _vvec_next_capacity(size_t capacity, size_t min_capacity, size_t stride, double scale, size_t page)
+{
+    size_t step = (size_t)((double)capacity * scale);
+    size_t new_capacity = capacity + ((step)? step : 1);
+    if (new_capacity < min_capacity) {
+        new_capacity = min_capacity;
+    }
+
+    // Past one page, round the buffer up to whole pages so big vectors grow in page steps
+    if (page && stride && new_capacity * stride > page) {
+        size_t bytes = (new_capacity * stride + page - 1) / page * page;
+        new_capacity = bytes / stride;
+    }
+    return new_capacity;
+}
+
+// Capacity to grow to when `min_capacity` items no longer fit
+static size_t _vvec_grown_capacity(vvec_t* vec, size_t min_capacity)
+{
+    return _vvec_next_capacity(vec->capacity, min_capacity, vec->stride, vec->scale, vec->growth_page);
+}
+
 size_t vvec_get_field(vvec_t* vec, VVEC_FIELD field)
 {
     if (!vec) return 0;
@@ -103,7 +338,11 @@ size_t vvec_get_field(vvec_t* vec, VVEC_FIELD field)
         case VVEC_FIELD_STRIDE:       return vec->stride;
         case VVEC_FIELD_LENGTH:       return vec->size;
         case VVEC_FIELD_CAPACITY:     return vec->capacity;
-        case VVEC_FIELD_SCALE_PERCENT:return vec->scale;
+        case VVEC_FIELD_SCALE_PERCENT:return (size_t)(vec->scale * 100.0 + 0.5);
+        case VVEC_FIELD_INLINE_CAPACITY:return vec->inline_capacity;
+        case VVEC_FIELD_GROWTH_PAGE:  return vec->growth_page;
+        case VVEC_FIELD_ALIGNMENT:    return vec->align;
+        case VVEC_FIELD_ALLOCATOR:    return (size_t)vec->allocator;
         default:                      break;
     }
 
@@ -115,19 +354,20 @@ size_t vvec_get_field(vvec_t* vec, VVEC_FIELD field)
         case VVEC1_FIELD_CTOR:        return (size_t)((_vvec1_t*)vec)->ctor;
         case VVEC1_FIELD_CCTOR:       return (size_t)((_vvec1_t*)vec)->cctor;
         case VVEC1_FIELD_DTOR:        return (size_t)((_vvec1_t*)vec)->dtor;
+        case VVEC1_FIELD_TRIVIAL:     return ((_vvec1_t*)vec)->trivial;
         default:                      return 0;
     }
 }
 
 static int _vvec_to_ver(vvec_t* vec, size_t ver){
+    // The header can not change size while items live right behind it
+    if(vec->inline_capacity) return -1;
     if(ver == VVEC_VER_1_0){
-        _vvec1_t* new_data = (_vvec1_t*)realloc(vec, sizeof(_vvec1_t));
-        new_data->ctor = __def_vvec_ctor;
-        new_data->cctor = __def_vvec_cctor;
-        new_data->dtor = __def_vvec_dtor;
+        _vvec1_t* new_data = (_vvec1_t*)_vstd_resize(vec->allocator, VSTD_MEM_VVEC, vec, _vvec_header_bytes(vec), sizeof(_vvec1_t), 0);
         if(!new_data) return -1;
+        _vvec1_init(new_data, NULL, NULL, NULL);
     }else{//VVEC_VER_0_0
-        vvec_t* new_data = (vvec_t*)realloc(vec, sizeof(vvec_t));
+        vvec_t* new_data = (vvec_t*)_vstd_resize(vec->allocator, VSTD_MEM_VVEC, vec, _vvec_header_bytes(vec), sizeof(vvec_t), 0);
         if(!new_data) return -1;
     }
     return 0;
@@ -145,14 +385,7 @@ static void _vvec_pop_at(vvec_t* vec, ssize_t index)
     size_t nindex = (index < 0) ? (size_t)(vec->size + index) : (size_t)index;
     assert(nindex < vec->size && "index out-of-range");
 
-    if (vec->ver == VVEC_VER_0_0)
-    { 
-        __def_vvec_dtor(vec->data + (nindex * vec->stride), vec->stride);
-    } 
-    else 
-    {
-        ((_vvec1_t*)vec)->dtor(vec->data + (nindex * vec->stride), vec->stride);
-    }
+    _vvec_destroy_range(vec, nindex, nindex + 1);
 
     if (nindex < vec->size - 1) 
     {
@@ -162,25 +395,16 @@ static void _vvec_pop_at(vvec_t* vec, ssize_t index)
     }
 
     vec->size--;
-    vec->capacity++;
 }
 
 static void _vvec_erase(vvec_t* vec, ssize_t start, ssize_t end)
 {
     size_t Ustart = (start < 0) ? (size_t)(vec->size + start) : (size_t)start;
     size_t Uend = (end < 0) ? (size_t)(vec->size + end) : (size_t)end;
-    assert(Ustart < Uend && "index out-of-range");
+    assert(Ustart <= Uend && "index out-of-range");
     assert(Uend <= vec->size && "index out-of-range");
 
-    for (size_t i = Ustart; i < Uend; i++)
-    {
-        if (vec->ver == VVEC_VER_0_0) 
-        {
-            __def_vvec_dtor(vec->data + (i * vec->stride), vec->stride);
-        } else {
-            ((_vvec1_t*)vec)->dtor(vec->data + (i * vec->stride), vec->stride);
-        }
-    }
+    _vvec_destroy_range(vec, Ustart, Uend);
     if (Uend < vec->size) {
         memmove(vec->data + (Ustart * vec->stride), 
                 vec->data + (Uend * vec->stride), 
@@ -195,25 +419,14 @@ static int _vvec_resize(vvec_t* vec, size_t new_size, int is_capacity)
     {
         if (new_size < vec->size)
         {
-            vvec1_dtor_t dtor = (vec->ver == VVEC_VER_1_0) ? ((_vvec1_t*)vec)->dtor : __def_vvec_dtor;
-            for (size_t i = new_size; i < vec->size; i++)
-            {
-                dtor(vec->data + (i * vec->stride), vec->stride);
-            }
+            _vvec_destroy_range(vec, new_size, vec->size);
             vec->size = new_size;
-            
-            void* new_data = realloc(vec->data, new_size * vec->stride);
-            if (!new_data) return -1;
-            vec->data = new_data;
-            vec->capacity = new_size;
+
+            if (_vvec_realloc_data(vec, new_size) == -1) return -1;
         }
         else if (new_size > vec->capacity)
         {
-            void* new_data = realloc(vec->data, new_size * vec->stride);
-            if (!new_data) return -1;
-            vec->data = new_data;
-            
-            vec->capacity = new_size;
+            if (_vvec_realloc_data(vec, new_size) == -1) return -1;
         }
     }
     else
@@ -225,8 +438,13 @@ static int _vvec_resize(vvec_t* vec, size_t new_size, int is_capacity)
             }
             
             vvec1_ctor_t ctor = (vec->ver == VVEC_VER_1_0) ? ((_vvec1_t*)vec)->ctor : __def_vvec_ctor;
-            for (size_t i = vec->size; i < new_size; i++) {
-                ctor(vec->data + (i * vec->stride), vec->stride, NULL, 0);
+            if (ctor == __def_vvec_ctor) {
+                // Default construction zeroes the items, one memset covers the whole range
+                memset(vec->data + (vec->size * vec->stride), 0, (new_size - vec->size) * vec->stride);
+            } else {
+                for (size_t i = vec->size; i < new_size; i++) {
+                    ctor(vec->data + (i * vec->stride), vec->stride, NULL, 0);
+                }
             }
             
             vec->size = new_size;
@@ -249,15 +467,7 @@ int vvec_scale(vvec_t* vec)
 {
     if (!vec) return -1;
 
-    size_t new_capacity = vec->capacity ? vec->capacity * (1 + (size_t)vec->scale) : 1;
-
-    unsigned char* new_data = (unsigned char*)realloc(vec->data, new_capacity * vec->stride);
-    if (!new_data) return -1; 
-
-    vec->data = new_data;
-    vec->capacity = new_capacity;
-
-    return 0;
+    return _vvec_realloc_data(vec, _vvec_grown_capacity(vec, vec->size + 1));
 }
 
 void vvec_set_field(vvec_t* vec, VVEC_FIELD field, size_t value)
@@ -269,7 +479,9 @@ void vvec_set_field(vvec_t* vec, VVEC_FIELD field, size_t value)
         case VVEC_FIELD_VER:           {_vvec_to_ver(vec, value); return;}
         case VVEC_FIELD_CAPACITY:      {_vvec_resize(vec, value, 1/*yes*/); return;}
         case VVEC_FIELD_LENGTH:        {_vvec_resize(vec, value, 0/*no*/); return;}
-        case VVEC_FIELD_SCALE_PERCENT: {vec->scale = ((double)value); return;};
+        case VVEC_FIELD_SCALE_PERCENT: {vec->scale = ((double)value) / 100.0; return;};
+        case VVEC_FIELD_GROWTH_PAGE:   {vec->growth_page = value; return;}
+        case VVEC_FIELD_ALIGNMENT:     {_vvec_realign(vec, value); return;}
         default: break;
     }
 
@@ -279,11 +491,88 @@ void vvec_set_field(vvec_t* vec, VVEC_FIELD field, size_t value)
 
     switch (field)
     {
-        case VVEC1_FIELD_CTOR:        {((_vvec1_t*)vec)->ctor; return;}
-        case VVEC1_FIELD_CCTOR:       {((_vvec1_t*)vec)->cctor; return;}
-        case VVEC1_FIELD_DTOR:        {((_vvec1_t*)vec)->dtor; return;}
+        case VVEC1_FIELD_CTOR:        {((_vvec1_t*)vec)->ctor = (value)? (vvec1_ctor_t)value : __def_vvec_ctor; break;}
+        case VVEC1_FIELD_CCTOR:       {((_vvec1_t*)vec)->cctor = (value)? (vvec1_cctor_t)value : __def_vvec_cctor; break;}
+        case VVEC1_FIELD_DTOR:        {((_vvec1_t*)vec)->dtor = (value)? (vvec1_dtor_t)value : __def_vvec_dtor; break;}
+        case VVEC1_FIELD_TRIVIAL:     {((_vvec1_t*)vec)->trivial = (value != 0); return;}
         default:                        return;
     }
+
+    // Changing a callback redoes the detection, VVEC1_FIELD_TRIVIAL can override it afterwards
+    ((_vvec1_t*)vec)->trivial = _vvec1_defaults((_vvec1_t*)vec);
+}
+
+// Makes room for `count` more items with a single growth step
+static int _vvec_reserve_for(vvec_t* vec, size_t count)
+{
+    size_t needed = vec->size + count;
+    if (needed <= vec->capacity) return 0;
+    return _vvec_realloc_data(vec, _vvec_grown_capacity(vec, needed));
+}
+
+// Copy constructs `count` items from `items` into `dst`, undoing the copies made so far on failure
+static int _vvec_copy_items(vvec_t* vec, char* dst, const char* items, size_t count)
+{
+    if (_vvec_is_trivial(vec)) {
+        memcpy(dst, items, count * vec->stride);
+        return 0;
+    }
+
+    vvec1_cctor_t cctor = ((_vvec1_t*)vec)->cctor;
+    for (size_t i = 0; i < count; i++) {
+        if (cctor(dst + (i * vec->stride), items + (i * vec->stride), vec->stride) != 0) {
+            vvec1_dtor_t dtor = ((_vvec1_t*)vec)->dtor;
+            while (i--) {
+                dtor(dst + (i * vec->stride), vec->stride);
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int vvec_append_n(vvec_t* vec, const void* items, size_t count)
+{
+    if (!vec || (!items && count)) return -1;
+    if (!count) return 0;
+
+    if (_vvec_reserve_for(vec, count) == -1) return -1;
+    if (_vvec_copy_items(vec, vec->data + (vec->size * vec->stride), (const char*)items, count) == -1) return -1;
+
+    vec->size += count;
+    return 0;
+}
+
+int vvec_insert_range(vvec_t* vec, ssize_t index, const void* items, size_t count)
+{
+    if (!vec || (!items && count)) return -1;
+
+    size_t nindex = (index < 0) ? (size_t)(vec->size + index) : (size_t)index;
+    assert(nindex <= vec->size && "index out-of-range");
+    if (!count) return 0;
+
+    if (_vvec_reserve_for(vec, count) == -1) return -1;
+
+    char* gap = vec->data + (nindex * vec->stride);
+    size_t tail = (vec->size - nindex) * vec->stride;
+    memmove(gap + (count * vec->stride), gap, tail);
+
+    if (_vvec_copy_items(vec, gap, (const char*)items, count) == -1) {
+        memmove(gap, gap + (count * vec->stride), tail);
+        return -1;
+    }
+
+    vec->size += count;
+    return 0;
+}
+
+int vvec_assign(vvec_t* vec, const void* items, size_t count)
+{
+    if (!vec || (!items && count)) return -1;
+
+    _vvec_destroy_range(vec, 0, vec->size);
+    vec->size = 0;
+    return vvec_append_n(vec, items, count);
 }
 
 int vvec_reserve(vvec_t* vec, size_t count)
@@ -300,14 +589,7 @@ int vvec_push_back(vvec_t* vec, const void* original)
         if (vvec_scale(vec) == -1) return -1;
     }
 
-    int ret = 0;
-    if (vec->ver == VVEC_VER_0_0){ 
-        ret = __def_vvec_cctor(vec->data + (vec->size * vec->stride), original, vec->stride);
-    } 
-    else 
-    {
-        ret = ((_vvec1_t*)vec)->cctor(vec->data + (vec->size * vec->stride), original, vec->stride);
-    }
+    int ret = _vvec_copy_item(vec, vec->data + (vec->size * vec->stride), original);
 
     if(ret != 0) 
     {
@@ -366,12 +648,7 @@ int vvec_insert(vvec_t* vec, ssize_t index, const void* original)
             vec->data + nindex * vec->stride, 
             (vec->size - nindex) * vec->stride);
 
-    int ret = 0;
-    if (vec->ver == VVEC_VER_0_0){
-        ret = __def_vvec_cctor(vec->data + (nindex * vec->stride), original, vec->stride);
-    }else{
-        ret = ((_vvec1_t*)vec)->cctor(vec->data + (nindex * vec->stride), original, vec->stride);
-    }
+    int ret = _vvec_copy_item(vec, vec->data + (nindex * vec->stride), original);
 
     if (ret != 0) {
         memmove(vec->data + nindex * vec->stride, 
@@ -434,6 +711,17 @@ void * vvec_at(vvec_t* vec, ssize_t index)
     return _vvec_at(vec, index);
 }
 
+vvec_view_t vvec_view(vvec_t* vec)
+{
+    vvec_view_t view = { NULL, 0, 0 };
+    if (!vec) return view;
+
+    view.data = vec->data;
+    view.size = vec->size;
+    view.stride = vec->stride;
+    return view;
+}
+
 void vvec_pop_at(vvec_t* vec, ssize_t index)
 {
     if (!vec) return;
@@ -446,28 +734,92 @@ void vvec_erase(vvec_t* vec, ssize_t start, ssize_t end)
     _vvec_erase(vec, start, end);
 }
 
+void vvec_swap_remove(vvec_t* vec, ssize_t index)
+{
+    if (!vec) return;
+
+    size_t nindex = (index < 0) ? (size_t)(vec->size + index) : (size_t)index;
+    assert(nindex < vec->size && "index out-of-range");
+
+    _vvec_destroy_range(vec, nindex, nindex + 1);
+
+    size_t last = vec->size - 1;
+    if (nindex != last) {
+        memcpy(vec->data + (nindex * vec->stride), vec->data + (last * vec->stride), vec->stride);
+    }
+    vec->size--;
+}
+
+size_t vvec_remove_if(vvec_t* vec, vvec_pred_fn pred, void* ctx)
+{
+    if (!vec || !pred) return 0;
+
+    // Kept items slide down over the removed ones, each one moves at most once
+    size_t kept = 0;
+    for (size_t i = 0; i < vec->size; i++) {
+        char* item = vec->data + (i * vec->stride);
+        if (pred(item, ctx)) {
+            _vvec_destroy_range(vec, i, i + 1);
+        } else {
+            if (kept != i) {
+                memcpy(vec->data + (kept * vec->stride), item, vec->stride);
+            }
+            kept++;
+        }
+    }
+
+    size_t removed = vec->size - kept;
+    vec->size = kept;
+    return removed;
+}
+
 void vvec_clear(vvec_t* vec)
 {
     if (!vec) return;
     _vvec_erase(vec, 0, vec->size);
 }
 
+// Moves items out of the inline storage so `data` can change owner
+static int _vvec_spill(vvec_t* vec)
+{
+    char* inline_data = _vvec_inline_data(vec);
+    if (!inline_data || vec->data != inline_data) return 0;
+
+    char* new_data = _vvec_data_alloc(vec, _vvec_data_bytes(vec, vec->capacity));
+    if (!new_data) return -1;
+    memcpy(new_data, inline_data, vec->size * vec->stride);
+    vec->data = new_data;
+    return 0;
+}
+
 void vvec_swap(vvec_t* lhs, vvec_t* rhs)
 {
-    assert(lhs == rhs && "pointer are restricted from pointing to the same address");
+    assert(lhs != rhs && "pointer are restricted from pointing to the same address");
     if(lhs->stride != rhs->stride) printf("vvec Warning: stride is not the same size for {lhs} and {rhs} in file: %s line: %d", __FILE__, __LINE__);
+    //each buffer has to go back to the allocator it came from
+    if(lhs->allocator != rhs->allocator) {
+        printf("vvec Warning: {lhs} and {rhs} use different allocators, not swapping in file: %s line: %d", __FILE__, __LINE__);
+        return;
+    }
+    if(_vvec_spill(lhs) == -1 || _vvec_spill(rhs) == -1) return;
+
+    //the inline storage belongs to the header, so it stays where it is
+    size_t lhs_inline = lhs->inline_capacity;
+    size_t rhs_inline = rhs->inline_capacity;
+
     //swaping things like meta data and the arrary data pointers
     if(lhs->ver == VVEC_VER_1_0 && rhs->ver == VVEC_VER_1_0){
         _vvec1_t temp = *(_vvec1_t*)lhs;
+        *(_vvec1_t*)lhs = *(_vvec1_t*)rhs;
+        *(_vvec1_t*)rhs = temp;
+    } else {
+        vvec_t temp = *lhs;
         *lhs = *rhs;
-
-        vvec_t * t = (vvec_t*)&temp;
-        *rhs = *t;
-        return;
+        *rhs = temp;
     }
-    vvec_t temp = *lhs;
-    *lhs = *rhs;
-    *rhs = temp;
+
+    lhs->inline_capacity = lhs_inline;
+    rhs->inline_capacity = rhs_inline;
 }
 
 void vvec_shrink_to_fit(vvec_t* vec)
@@ -475,8 +827,7 @@ void vvec_shrink_to_fit(vvec_t* vec)
     if(!vec) return;
     if(vec->capacity == vec->size) return;
     //else
-    vec->capacity = vec->size;
-    void * new_data = realloc(vec->data, vec->capacity);
+    _vvec_realloc_data(vec, vec->size);
 }
 
 void vvec_destroy(vvec_t** vec)
@@ -484,7 +835,560 @@ void vvec_destroy(vvec_t** vec)
     if (vec && *vec)
     {    
         _vvec_erase(*vec, 0, (*vec)->size);
-        free(*vec);
+        if ((*vec)->data != _vvec_inline_data(*vec)) {
+            _vvec_data_free(*vec, (*vec)->data, _vvec_data_bytes(*vec, (*vec)->capacity));
+        }
+        _vstd_release((*vec)->allocator, VSTD_MEM_VVEC, *vec, _vvec_header_bytes(*vec), 0);
         *vec = NULL;
     }
-}
\ No newline at end of file
+}
+/*
+    Search, fill and compare kernels:
+    Elements of 1, 2, 4, 8 or 16 bytes divide a vector register evenly, so the key is
+    repeated across a whole register and each block is compared bytewise in one go.
+    An element matches when all of its byte lanes match. The kernel is chosen at runtime
+    (AVX2 if the CPU and OS support it, else SSE2), other strides and non x86 targets use
+    the scalar loop. Define VVEC_NO_SIMD to always use the scalar loop.
+*/
+#if !defined(VVEC_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define VVEC_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define VVEC_TARGET_AVX2
+    #else
+        #define VVEC_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+#define VVEC_SIMD_SCALAR 0
+#define VVEC_SIMD_SSE2 1
+#define VVEC_SIMD_AVX2 2
+
+// Returns 1 if `stride` fills a vector register with whole elements
+static int _vvec_simd_stride(size_t stride)
+{
+    return stride == 1 || stride == 2 || stride == 4 || stride == 8 || stride == 16;
+}
+
+static int _vvec_item_equal(const char* item, const char* key, size_t stride)
+{
+    switch (stride) {
+    case 1: return *item == *key;
+    case 2: { uint16_t a, b; memcpy(&a, item, 2); memcpy(&b, key, 2); return a == b; }
+    case 4: { uint32_t a, b; memcpy(&a, item, 4); memcpy(&b, key, 4); return a == b; }
+    case 8: { uint64_t a, b; memcpy(&a, item, 8); memcpy(&b, key, 8); return a == b; }
+    default: return memcmp(item, key, stride) == 0;
+    }
+}
+
+// Finds the first match (returns `count` if none) or counts all matches in [begin, count)
+static size_t _vvec_scan_scalar(const char* data, size_t begin, size_t count, size_t stride, const char* key, int first)
+{
+    size_t found = 0;
+    for (size_t i = begin; i < count; i++) {
+        if (_vvec_item_equal(data + (i * stride), key, stride)) {
+            if (first) return i;
+            found++;
+        }
+    }
+    return (first)? count : found;
+}
+
+#ifdef VVEC_SIMD_X86
+
+static int _vvec_simd_level(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    static volatile int level = -1; // Same value from every thread, so a racing first call is harmless
+    if (level < 0) {
+        int info[4];
+        int avx2 = 0;
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            int osxsave = (info[2] & (1 << 27)) != 0;
+            __cpuidex(info, 7, 0);
+            avx2 = osxsave && (info[1] & (1 << 5)) && (_xgetbv(0) & 6) == 6;
+        }
+        level = (avx2)? VVEC_SIMD_AVX2 : VVEC_SIMD_SSE2;
+    }
+    return level;
+#else
+    return (__builtin_cpu_supports("avx2"))? VVEC_SIMD_AVX2 : VVEC_SIMD_SSE2;
+#endif
+}
+
+static unsigned _vvec_ctz(unsigned mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static size_t _vvec_popcount(unsigned mask)
+{
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return (size_t)((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+// Turns a bytewise compare mask into one bit per matching element (at the element's first byte)
+static unsigned _vvec_lane_mask(unsigned mask, size_t stride)
+{
+    if (stride >= 2) mask &= mask >> 1;
+    if (stride >= 4) mask &= mask >> 2;
+    if (stride >= 8) mask &= mask >> 4;
+    if (stride >= 16) mask &= mask >> 8;
+
+    switch (stride) {
+    case 1: return mask;
+    case 2: return mask & 0x55555555u;
+    case 4: return mask & 0x11111111u;
+    case 8: return mask & 0x01010101u;
+    default: return mask & 0x00010001u;
+    }
+}
+
+// Repeats `key` across `bytes` bytes
+static void _vvec_pattern(char* pattern, size_t bytes, const char* key, size_t stride)
+{
+    for (size_t i = 0; i < bytes; i += stride) {
+        memcpy(pattern + i, key, stride);
+    }
+}
+
+static size_t _vvec_scan_sse2(const char* data, size_t count, size_t stride, const char* key, int first)
+{
+    char pattern[16];
+    _vvec_pattern(pattern, sizeof(pattern), key, stride);
+    __m128i needle = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t per = sizeof(pattern) / stride, found = 0, i = 0;
+    for (; i + per <= count; i += per) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + (i * stride)));
+        unsigned mask = _vvec_lane_mask((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)), stride);
+        if (mask) {
+            if (first) return i + (_vvec_ctz(mask) / stride);
+            found += _vvec_popcount(mask);
+        }
+    }
+    return (first)? _vvec_scan_scalar(data, i, count, stride, key, 1) : found + _vvec_scan_scalar(data, i, count, stride, key, 0);
+}
+
+VVEC_TARGET_AVX2
+static size_t _vvec_scan_avx2(const char* data, size_t count, size_t stride, const char* key, int first)
+{
+    char pattern[32];
+    _vvec_pattern(pattern, sizeof(pattern), key, stride);
+    __m256i needle = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t per = sizeof(pattern) / stride, found = 0, i = 0;
+    for (; i + per <= count; i += per) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + (i * stride)));
+        unsigned mask = _vvec_lane_mask((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)), stride);
+        if (mask) {
+            if (first) return i + (_vvec_ctz(mask) / stride);
+            found += _vvec_popcount(mask);
+        }
+    }
+    return (first)? _vvec_scan_scalar(data, i, count, stride, key, 1) : found + _vvec_scan_scalar(data, i, count, stride, key, 0);
+}
+
+static void _vvec_fill_sse2(char* data, size_t bytes, const char* key, size_t stride)
+{
+    char pattern[16];
+    _vvec_pattern(pattern, sizeof(pattern), key, stride);
+    __m128i value = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t i = 0;
+    for (; i + sizeof(pattern) <= bytes; i += sizeof(pattern)) {
+        _mm_storeu_si128((__m128i*)(data + i), value);
+    }
+    memcpy(data + i, pattern, bytes - i);
+}
+
+VVEC_TARGET_AVX2
+static void _vvec_fill_avx2(char* data, size_t bytes, const char* key, size_t stride)
+{
+    char pattern[32];
+    _vvec_pattern(pattern, sizeof(pattern), key, stride);
+    __m256i value = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t i = 0;
+    for (; i + sizeof(pattern) <= bytes; i += sizeof(pattern)) {
+        _mm256_storeu_si256((__m256i*)(data + i), value);
+    }
+    memcpy(data + i, pattern, bytes - i);
+}
+
+#endif // VVEC_SIMD_X86
+
+static size_t _vvec_scan(vvec_t* vec, const char* key, int first)
+{
+#ifdef VVEC_SIMD_X86
+    if (_vvec_simd_stride(vec->stride)) {
+        if (_vvec_simd_level() == VVEC_SIMD_AVX2) {
+            return _vvec_scan_avx2(vec->data, vec->size, vec->stride, key, first);
+        }
+        return _vvec_scan_sse2(vec->data, vec->size, vec->stride, key, first);
+    }
+#endif
+    return _vvec_scan_scalar(vec->data, 0, vec->size, vec->stride, key, first);
+}
+
+ssize_t vvec_find(vvec_t* vec, const void* key)
+{
+    if (!vec || !key) return -1;
+
+    size_t index = _vvec_scan(vec, (const char*)key, 1);
+    return (index < vec->size)? (ssize_t)index : -1;
+}
+
+size_t vvec_count(vvec_t* vec, const void* key)
+{
+    if (!vec || !key) return 0;
+    return _vvec_scan(vec, (const char*)key, 0);
+}
+
+int vvec_fill(vvec_t* vec, const void* value)
+{
+    if (!vec || !value) return -1;
+    if (!vec->size) return 0;
+
+    if (!_vvec_is_trivial(vec)) {
+        _vvec1_t* vec1 = (_vvec1_t*)vec;
+        // `value` may be one of the items, so fill from a full copy of it
+        char* copy = (char*)_vstd_alloc(vec->allocator, VSTD_MEM_VVEC, vec->stride, 0);
+        if (!copy) return -1;
+        if (vec1->cctor(copy, value, vec->stride) != 0) {
+            _vstd_release(vec->allocator, VSTD_MEM_VVEC, copy, vec->stride, 0);
+            return -1;
+        }
+
+        int ret = 0;
+        for (size_t i = 0; i < vec->size; i++) {
+            char* item = vec->data + (i * vec->stride);
+            vec1->dtor(item, vec->stride);
+            ret = vec1->cctor(item, copy, vec->stride);
+            if (ret != 0) {
+                // Item i is gone, keep only the items before it
+                _vvec_destroy_range(vec, i + 1, vec->size);
+                vec->size = i;
+                break;
+            }
+        }
+        vec1->dtor(copy, vec->stride);
+        _vstd_release(vec->allocator, VSTD_MEM_VVEC, copy, vec->stride, 0);
+        return (ret == 0)? 0 : -1;
+    }
+
+    size_t bytes = vec->size * vec->stride;
+    if (vec->stride == 1) {
+        memset(vec->data, *(const char*)value, bytes);
+        return 0;
+    }
+#ifdef VVEC_SIMD_X86
+    if (_vvec_simd_stride(vec->stride)) {
+        char key[16];
+        memcpy(key, value, vec->stride);
+        if (_vvec_simd_level() == VVEC_SIMD_AVX2) {
+            _vvec_fill_avx2(vec->data, bytes, key, vec->stride);
+        } else {
+            _vvec_fill_sse2(vec->data, bytes, key, vec->stride);
+        }
+        return 0;
+    }
+#endif
+    // Other strides: place one item, then keep doubling the filled prefix
+    memmove(vec->data, value, vec->stride);
+    for (size_t filled = vec->stride; filled < bytes; filled *= 2) {
+        memcpy(vec->data + filled, vec->data, (bytes - filled < filled)? bytes - filled : filled);
+    }
+    return 0;
+}
+
+int vvec_equal(vvec_t* lhs, vvec_t* rhs)
+{
+    if (!lhs || !rhs) return lhs == rhs;
+    if (lhs->stride != rhs->stride || lhs->size != rhs->size) return 0;
+    if (!lhs->size) return 1;
+    // One contiguous compare, the C runtime's memcmp is already vectorized
+    return memcmp(lhs->data, rhs->data, lhs->size * lhs->stride) == 0;
+}
+
+/*
+    Sorting:
+    One introsort body is inlined into a wrapper per common stride, so with a constant
+    stride every copy and swap turns into a few register moves instead of memcpy calls.
+    Ranges wait on an explicit stack (the larger side is pushed, the smaller one sorted
+    first), which keeps the depth below 64 and lets the body be inlined.
+*/
+#if defined(_MSC_VER)
+    #define VVEC_FORCE_INLINE static __forceinline
+#else
+    #define VVEC_FORCE_INLINE static inline __attribute__((always_inline))
+#endif
+
+#define VVEC_SORT_CUTOFF 16     // Ranges this small are finished with insertion sort
+#define VVEC_SORT_SCRATCH 64    // Elements up to this size use a stack buffer
+
+VVEC_FORCE_INLINE void _vvec_sort_swap(char* a, char* b, size_t stride)
+{
+    switch (stride) {
+    case 4: { uint32_t t; memcpy(&t, a, 4); memcpy(a, b, 4); memcpy(b, &t, 4); return; }
+    case 8: { uint64_t t; memcpy(&t, a, 8); memcpy(a, b, 8); memcpy(b, &t, 8); return; }
+    case 16: { uint64_t t[2]; memcpy(t, a, 16); memcpy(a, b, 16); memcpy(b, t, 16); return; }
+    default: {
+        char t[VVEC_SORT_SCRATCH];
+        while (stride) {
+            size_t n = (stride < sizeof(t))? stride : sizeof(t);
+            memcpy(t, a, n); memcpy(a, b, n); memcpy(b, t, n);
+            a += n; b += n; stride -= n;
+        }
+    }
+    }
+}
+
+VVEC_FORCE_INLINE void _vvec_insertion_sort(char* base, size_t lo, size_t hi, size_t stride, vvec_cmp_fn cmp, char* tmp)
+{
+    for (size_t i = lo + 1; i < hi; i++) {
+        char* item = base + (i * stride);
+        if (cmp(item, item - stride) >= 0) continue;
+
+        memcpy(tmp, item, stride);
+        size_t j = i;
+        do {
+            memcpy(base + (j * stride), base + ((j - 1) * stride), stride);
+            j--;
+        } while (j > lo && cmp(tmp, base + ((j - 1) * stride)) < 0);
+        memcpy(base + (j * stride), tmp, stride);
+    }
+}
+
+VVEC_FORCE_INLINE void _vvec_sift_down(char* base, size_t root, size_t count, size_t stride, vvec_cmp_fn cmp)
+{
+    for (;;) {
+        size_t child = (2 * root) + 1;
+        if (child >= count) return;
+        if (child + 1 < count && cmp(base + (child * stride), base + ((child + 1) * stride)) < 0) child++;
+        if (cmp(base + (root * stride), base + (child * stride)) >= 0) return;
+        _vvec_sort_swap(base + (root * stride), base + (child * stride), stride);
+        root = child;
+    }
+}
+
+// Fallback once a range has been split badly too often
+VVEC_FORCE_INLINE void _vvec_heap_sort(char* base, size_t count, size_t stride, vvec_cmp_fn cmp)
+{
+    for (size_t i = count / 2; i-- > 0;) {
+        _vvec_sift_down(base, i, count, stride, cmp);
+    }
+    for (size_t end = count - 1; end > 0; end--) {
+        _vvec_sort_swap(base, base + (end * stride), stride);
+        _vvec_sift_down(base, 0, end, stride, cmp);
+    }
+}
+
+VVEC_FORCE_INLINE void _vvec_introsort(char* base, size_t count, size_t stride, vvec_cmp_fn cmp, char* tmp)
+{
+    struct { size_t lo, hi, depth; } stack[64];
+    size_t top = 0, depth = 0;
+    for (size_t n = count; n > 1; n >>= 1) depth += 2;
+
+    stack[top].lo = 0; stack[top].hi = count; stack[top].depth = depth; top++;
+    while (top) {
+        top--;
+        size_t lo = stack[top].lo, hi = stack[top].hi;
+        depth = stack[top].depth;
+
+        while (hi - lo > VVEC_SORT_CUTOFF) {
+            if (depth == 0) {
+                _vvec_heap_sort(base + (lo * stride), hi - lo, stride, cmp);
+                lo = hi;
+                break;
+            }
+            depth--;
+
+            // Median of three becomes the pivot at `lo`
+            char* a = base + (lo * stride);
+            char* m = base + ((lo + (hi - lo) / 2) * stride);
+            char* b = base + ((hi - 1) * stride);
+            if (cmp(m, a) < 0) _vvec_sort_swap(m, a, stride);
+            if (cmp(b, m) < 0) {
+                _vvec_sort_swap(b, m, stride);
+                if (cmp(m, a) < 0) _vvec_sort_swap(m, a, stride);
+            }
+            _vvec_sort_swap(a, m, stride);
+
+            // Both scans stop on equal items, so runs of duplicates split evenly
+            size_t i = lo + 1, j = hi - 1;
+            for (;;) {
+                while (i <= j && cmp(base + (i * stride), a) < 0) i++;
+                while (i <= j && cmp(base + (j * stride), a) > 0) j--;
+                if (i >= j) break;
+                _vvec_sort_swap(base + (i * stride), base + (j * stride), stride);
+                i++; j--;
+            }
+            if (j != lo) _vvec_sort_swap(a, base + (j * stride), stride);
+
+            if (j - lo > hi - (j + 1)) {
+                stack[top].lo = lo; stack[top].hi = j; stack[top].depth = depth; top++;
+                lo = j + 1;
+            } else {
+                stack[top].lo = j + 1; stack[top].hi = hi; stack[top].depth = depth; top++;
+                hi = j;
+            }
+        }
+        if (hi - lo > 1) {
+            _vvec_insertion_sort(base, lo, hi, stride, cmp, tmp);
+        }
+    }
+}
+
+static void _vvec_sort4(char* base, size_t count, vvec_cmp_fn cmp, char* tmp) { _vvec_introsort(base, count, 4, cmp, tmp); }
+static void _vvec_sort8(char* base, size_t count, vvec_cmp_fn cmp, char* tmp) { _vvec_introsort(base, count, 8, cmp, tmp); }
+static void _vvec_sort16(char* base, size_t count, vvec_cmp_fn cmp, char* tmp) { _vvec_introsort(base, count, 16, cmp, tmp); }
+static void _vvec_sortn(char* base, size_t count, size_t stride, vvec_cmp_fn cmp, char* tmp) { _vvec_introsort(base, count, stride, cmp, tmp); }
+
+int vvec_sort(vvec_t* vec, vvec_cmp_fn cmp)
+{
+    if (!vec || !cmp) return -1;
+    if (vec->size < 2) return 0;
+
+    // `cmp` sees the scratch element too, so it needs the element's alignment
+    union { long double ld; uint64_t u; void* p; char bytes[VVEC_SORT_SCRATCH]; } scratch;
+    char* tmp = scratch.bytes;
+    if (vec->stride > sizeof(scratch) || vec->align > 16) {
+        tmp = _vvec_data_alloc(vec, vec->stride);
+        if (!tmp) return -1;
+    }
+
+    switch (vec->stride) {
+    case 4: _vvec_sort4(vec->data, vec->size, cmp, tmp); break;
+    case 8: _vvec_sort8(vec->data, vec->size, cmp, tmp); break;
+    case 16: _vvec_sort16(vec->data, vec->size, cmp, tmp); break;
+    default: _vvec_sortn(vec->data, vec->size, vec->stride, cmp, tmp); break;
+    }
+
+    if (tmp != scratch.bytes) {
+        _vvec_data_free(vec, tmp, vec->stride);
+    }
+    return 0;
+}
+
+/*
+    Radix sort:
+    Keys are mapped to unsigned integers that sort the same way, then (key, index) pairs
+    go through one counting pass per key byte. Bytes that are the same for every key are
+    skipped. The elements themselves are moved once at the end.
+*/
+typedef struct _vvec_radix_t
+{
+    uint64_t key;
+    size_t index;
+} _vvec_radix_t;
+
+static uint64_t _vvec_radix_key(const char* item, VVEC_KEY key)
+{
+    switch (key) {
+    case VVEC_KEY_U32: { uint32_t v; memcpy(&v, item, 4); return v; }
+    case VVEC_KEY_I32: { uint32_t v; memcpy(&v, item, 4); return v ^ 0x80000000u; }
+    case VVEC_KEY_F32: { uint32_t v; memcpy(&v, item, 4); return (v & 0x80000000u)? (uint32_t)~v : v | 0x80000000u; }
+    case VVEC_KEY_U64: { uint64_t v; memcpy(&v, item, 8); return v; }
+    case VVEC_KEY_I64: { uint64_t v; memcpy(&v, item, 8); return v ^ 0x8000000000000000ull; }
+    default:           { uint64_t v; memcpy(&v, item, 8); return (v >> 63)? ~v : v | 0x8000000000000000ull; }
+    }
+}
+
+int vvec_sort_by_key(vvec_t* vec, VVEC_KEY key, size_t key_offset)
+{
+    if (!vec || key < VVEC_KEY_U32 || key > VVEC_KEY_F64) return -1;
+
+    size_t key_size = (key <= VVEC_KEY_F32)? 4 : 8;
+    if (key_offset + key_size > vec->stride) return -1;
+    if (vec->size < 2) return 0;
+
+    size_t count = vec->size, stride = vec->stride;
+    size_t pairs_bytes = 2 * count * sizeof(_vvec_radix_t);
+    size_t hist_bytes = 8 * sizeof(size_t[256]);
+    _vvec_radix_t* pairs = (_vvec_radix_t*)_vstd_alloc(vec->allocator, VSTD_MEM_VVEC, pairs_bytes, 0);
+    char* sorted = (char*)_vstd_alloc(vec->allocator, VSTD_MEM_VVEC, count * stride, 0);
+    size_t (*hist)[256] = (size_t(*)[256])_vstd_alloc(vec->allocator, VSTD_MEM_VVEC, hist_bytes, 0); // One histogram per key byte
+    if (!pairs || !sorted || !hist) {
+        _vstd_release(vec->allocator, VSTD_MEM_VVEC, hist, hist_bytes, 0);
+        _vstd_release(vec->allocator, VSTD_MEM_VVEC, sorted, count * stride, 0);
+        _vstd_release(vec->allocator, VSTD_MEM_VVEC, pairs, pairs_bytes, 0);
+        return -1;
+    }
+    memset(hist, 0, hist_bytes);
+
+    _vvec_radix_t* src = pairs;
+    _vvec_radix_t* dst = pairs + count;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t k = _vvec_radix_key(vec->data + (i * stride) + key_offset, key);
+        src[i].key = k;
+        src[i].index = i;
+        for (size_t d = 0; d < key_size; d++) {
+            hist[d][(k >> (d * 8)) & 0xFF]++;
+        }
+    }
+
+    for (size_t d = 0; d < key_size; d++) {
+        size_t* counts = hist[d];
+        if (counts[(src[0].key >> (d * 8)) & 0xFF] == count) continue; // Every key has this byte
+
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; b++) {
+            size_t c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[counts[(src[i].key >> (d * 8)) & 0xFF]++] = src[i];
+        }
+        _vvec_radix_t* t = src; src = dst; dst = t;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        memcpy(sorted + (i * stride), vec->data + (src[i].index * stride), stride);
+    }
+    memcpy(vec->data, sorted, count * stride);
+
+    _vstd_release(vec->allocator, VSTD_MEM_VVEC, hist, hist_bytes, 0);
+    _vstd_release(vec->allocator, VSTD_MEM_VVEC, sorted, count * stride, 0);
+    _vstd_release(vec->allocator, VSTD_MEM_VVEC, pairs, pairs_bytes, 0);
+    return 0;
+}
+
+size_t vvec_lower_bound(vvec_t* vec, const void* key, vvec_cmp_fn cmp)
+{
+    if (!vec || !cmp) return 0;
+
+    size_t lo = 0, n = vec->size;
+    while (n > 0) {
+        size_t half = n / 2;
+        if (cmp(vec->data + ((lo + half) * vec->stride), key) < 0) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+ssize_t vvec_binary_search(vvec_t* vec, const void* key, vvec_cmp_fn cmp)
+{
+    if (!vec || !cmp) return -1;
+
+    size_t index = vvec_lower_bound(vec, key, cmp);
+    if (index < vec->size && cmp(vec->data + (index * vec->stride), key) == 0) {
+        return (ssize_t)index;
+    }
+    return -1;
+}
@@ -10,12 +10,21 @@ typedef SIZE_T size_t;
 #endif
 #endif
 #include <stdarg.h> // <---- will be useful for the emplace functions
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <vmem.h>
 
 //Represents the front index of a vector
 #define VVEC_FRONT (0)
 //Represents the back index of a vector
 #define VVEC_BACK (-1)
 
+//Once a vector's buffer is bigger than this many bytes it grows in whole steps of it (0 = off)
+#ifndef VVEC_GROWTH_PAGE
+#define VVEC_GROWTH_PAGE 4096
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -49,8 +58,36 @@ typedef enum VVEC_FIELD /* : int*/
     VVEC1_FIELD_CTOR           = 5,  /**< Contructor function for each element */
     VVEC1_FIELD_CCTOR          = 6,  /**< Copy contructor function for each element */
     VVEC1_FIELD_DTOR           = 7,  /**< Destructor function for each element */
+
+    //growth policy (any version)
+
+    VVEC_FIELD_INLINE_CAPACITY = 8,  /**< Number of elements stored inside the vvec allocation (read only) */
+    VVEC_FIELD_GROWTH_PAGE     = 9,  /**< Buffers larger than this many bytes grow in whole steps of it (0 = off) */
+
+    //vvec version 1.0 (element lifecycle)
+
+    VVEC1_FIELD_TRIVIAL        = 10, /**< 1 if elements are copied with memcpy and need no destructor.
+                                          Set automatically while the default callbacks are used, can be forced on */
+
+    //storage (any version)
+
+    VVEC_FIELD_ALIGNMENT       = 11, /**< Alignment of the element storage in bytes, 0 = malloc default. Setting it moves the storage */
+    VVEC_FIELD_ALLOCATOR       = 12, /**< const vallocator_t* the vector allocates from (read only) */
 } VVEC_FIELD;
 
+/**
+ * @brief Type of the key vvec_sort_by_key reads from each element.
+*/
+typedef enum VVEC_KEY /* : int*/
+{
+    VVEC_KEY_U32 = 0,  /**< uint32_t */
+    VVEC_KEY_I32 = 1,  /**< int32_t */
+    VVEC_KEY_F32 = 2,  /**< float */
+    VVEC_KEY_U64 = 3,  /**< uint64_t */
+    VVEC_KEY_I64 = 4,  /**< int64_t */
+    VVEC_KEY_F64 = 5,  /**< double */
+} VVEC_KEY;
+
 /**
  * @brief vector version 0.0 handle
 */
@@ -76,6 +113,27 @@ typedef int (*vvec1_cctor_t)(void * self, const void * original, size_t size);
 */
 typedef void (*vvec1_dtor_t)(void * self, size_t size);
 
+/**
+ * @brief Compares two elements, returns < 0 if `a` goes before `b`, 0 if they are equal and > 0 otherwise.
+*/
+typedef int (*vvec_cmp_fn)(const void* a, const void* b);
+
+/**
+ * @brief Returns non-zero if `item` should be removed by vvec_remove_if.
+*/
+typedef int (*vvec_pred_fn)(const void* item, void* ctx);
+
+/**
+ * @brief Plain snapshot of a vector's storage for tight loops.
+ * A view is invalidated by anything that changes the vector's size or capacity.
+*/
+typedef struct vvec_view_t
+{
+    char* data;     // First element
+    size_t size;    // Number of elements
+    size_t stride;  // Size of each element
+} vvec_view_t;
+
 /**
  * @brief Creates a vvec with the specified element stride, initial capacity, and scale factor.
  *
@@ -96,6 +154,61 @@ vvec_t* _vvec_create(size_t stride, size_t initial_capacity, double scale_factor
 */
 #define vvec_create(T, initial_capacity, scale_factor) (vvec_t*)_vvec_create(sizeof(T), initial_capacity, scale_factor)
 
+/**
+ * @brief Creates a vvec whose first `inline_capacity` elements live inside the vvec allocation itself.
+ * The elements move to the heap once the vector outgrows that storage,
+ * and back into it when vvec_shrink_to_fit makes them fit again.
+ *
+ * @param stride Size of each element in the vector.
+ * @param inline_capacity Number of elements stored inline.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @return Pointer to the newly created vvec, or NULL if creation fails.
+*/
+vvec_t* _vvec_create_inline(size_t stride, size_t inline_capacity, double scale_factor);
+
+/**
+ * @brief Creates a vvec whose first `inline_capacity` elements of type T live inside the vvec allocation.
+ *
+ * @param T Type of an element
+ * @param inline_capacity Number of elements stored inline.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @return Pointer to the newly created vvec, or NULL if creation fails.
+*/
+#define vvec_create_inline(T, inline_capacity, scale_factor) (vvec_t*)_vvec_create_inline(sizeof(T), inline_capacity, scale_factor)
+
+/**
+ * @brief Creates a vvec whose storage starts on an `alignment` byte boundary and keeps it across growth.
+ * The buffer size is rounded up to a multiple of `alignment`, so the last block is never shared.
+ *
+ * @param stride Size of each element in the vector.
+ * @param initial_capacity Initial number of elements the vector can hold.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @param alignment Power of two of at least sizeof(void*), e.g. 32 for AVX2 or 64 for AVX-512 and cache lines.
+ * @return Pointer to the newly created vvec, or NULL if creation fails or the alignment is invalid.
+*/
+vvec_t* _vvec_create_aligned(size_t stride, size_t initial_capacity, double scale_factor, size_t alignment);
+
+/**
+ * @brief Creates a vvec of type T whose storage is `alignment` byte aligned.
+*/
+#define vvec_create_aligned(T, initial_capacity, scale_factor, alignment) (vvec_t*)_vvec_create_aligned(sizeof(T), initial_capacity, scale_factor, alignment)
+
+/**
+ * @brief Creates a vvec whose header and buffers come from `allocator`.
+ *
+ * @param stride Size of each element in the vector.
+ * @param initial_capacity Initial number of elements the vector can hold.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the vector.
+ * @return Pointer to the newly created vvec, or NULL if creation fails.
+*/
+vvec_t* _vvec_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator);
+
+/**
+ * @brief Creates a vvec of type T that allocates from `allocator`.
+*/
+#define vvec_create_alloc(T, initial_capacity, scale_factor, allocator) (vvec_t*)_vvec_create_alloc(sizeof(T), initial_capacity, scale_factor, allocator)
+
 /**
  * @brief Creates a vvec with the specified element stride, initial capacity, and scale factor.
  *
@@ -106,6 +219,7 @@ vvec_t* _vvec_create(size_t stride, size_t initial_capacity, double scale_factor
  * @param cctor Copy constructor function to be called for when a vector is element is created, or NULL if default.
  * @param dtor Destructor function to be called for each element when the vector is destroyed, or NULL if default.
  * @return Pointer to the newly created vvec, or NULL if creation fails.
+ * @note With only default callbacks the elements are trivial: copies are a memcpy and destruction does nothing (see VVEC1_FIELD_TRIVIAL).
 */
 vvec1_t* _vvec1_create(size_t stride, size_t initial_capacity, double scale_factor, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor);
 
@@ -122,6 +236,62 @@ vvec1_t* _vvec1_create(size_t stride, size_t initial_capacity, double scale_fact
 */
 #define vvec1_create(T, initial_capacity, scale_factor, ctor, cctor, dtor) (vvec1_t*)_vvec1_create(sizeof(T), initial_capacity, scale_factor, ctor, cctor, dtor)
 
+/**
+ * @brief Creates a vvec1 whose first `inline_capacity` elements live inside the vvec allocation itself.
+ *
+ * @param stride Size of each element in the vector.
+ * @param inline_capacity Number of elements stored inline.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @param ctor Constructor function to be called for when a vector is element is created, or NULL if default.
+ * @param cctor Copy constructor function to be called for when a vector is element is created, or NULL if default.
+ * @param dtor Destructor function to be called for each element when the vector is destroyed, or NULL if default.
+ * @return Pointer to the newly created vvec, or NULL if creation fails.
+*/
+vvec1_t* _vvec1_create_inline(size_t stride, size_t inline_capacity, double scale_factor, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor);
+
+/**
+ * @brief Creates a vvec1 whose first `inline_capacity` elements of type T live inside the vvec allocation.
+*/
+#define vvec1_create_inline(T, inline_capacity, scale_factor, ctor, cctor, dtor) (vvec1_t*)_vvec1_create_inline(sizeof(T), inline_capacity, scale_factor, ctor, cctor, dtor)
+
+/**
+ * @brief Creates a vvec1 whose storage starts on an `alignment` byte boundary and keeps it across growth.
+ *
+ * @param stride Size of each element in the vector.
+ * @param initial_capacity Initial number of elements the vector can hold.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @param alignment Power of two of at least sizeof(void*).
+ * @param ctor Constructor function to be called for when a vector is element is created, or NULL if default.
+ * @param cctor Copy constructor function to be called for when a vector is element is created, or NULL if default.
+ * @param dtor Destructor function to be called for each element when the vector is destroyed, or NULL if default.
+ * @return Pointer to the newly created vvec, or NULL if creation fails or the alignment is invalid.
+*/
+vvec1_t* _vvec1_create_aligned(size_t stride, size_t initial_capacity, double scale_factor, size_t alignment, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor);
+
+/**
+ * @brief Creates a vvec1 of type T whose storage is `alignment` byte aligned.
+*/
+#define vvec1_create_aligned(T, initial_capacity, scale_factor, alignment, ctor, cctor, dtor) (vvec1_t*)_vvec1_create_aligned(sizeof(T), initial_capacity, scale_factor, alignment, ctor, cctor, dtor)
+
+/**
+ * @brief Creates a vvec1 whose header and buffers come from `allocator`.
+ *
+ * @param stride Size of each element in the vector.
+ * @param initial_capacity Initial number of elements the vector can hold.
+ * @param scale_factor Scale factor for dynamic resizing (0.5 = grow by half).
+ * @param allocator Allocator to use, NULL for vallocator_default(). It has to outlive the vector.
+ * @param ctor Constructor function to be called for when a vector is element is created, or NULL if default.
+ * @param cctor Copy constructor function to be called for when a vector is element is created, or NULL if default.
+ * @param dtor Destructor function to be called for each element when the vector is destroyed, or NULL if default.
+ * @return Pointer to the newly created vvec, or NULL if creation fails.
+*/
+vvec1_t* _vvec1_create_alloc(size_t stride, size_t initial_capacity, double scale_factor, const vallocator_t* allocator, vvec1_ctor_t ctor, vvec1_cctor_t cctor, vvec1_dtor_t dtor);
+
+/**
+ * @brief Creates a vvec1 of type T that allocates from `allocator`.
+*/
+#define vvec1_create_alloc(T, initial_capacity, scale_factor, allocator, ctor, cctor, dtor) (vvec1_t*)_vvec1_create_alloc(sizeof(T), initial_capacity, scale_factor, allocator, ctor, cctor, dtor)
+
 /**
  * @brief Retrieves a specific field's value from the vvec.
  *
@@ -232,6 +402,37 @@ int vvec_emplace(vvec_t* vec, ssize_t index, size_t arg_count, ...);
 */
 int vvec_emplace_back(vvec_t* vec, size_t arg_count, ...);
 
+/**
+ * @brief Copies `count` elements onto the back of the vector, growing it at most once.
+ *
+ * @param vec Pointer to the vvec.
+ * @param items Pointer to `count` contiguous elements (must not point into `vec`).
+ * @param count Number of elements to copy.
+ * @return 0 on success, or -1 on failure (the vector is left unchanged).
+*/
+int vvec_append_n(vvec_t* vec, const void* items, size_t count);
+
+/**
+ * @brief Copies `count` elements into the vector before `index`, growing it at most once.
+ *
+ * @param vec Pointer to the vvec.
+ * @param index Index value. Can be negative of positive, the length of the vector appends.
+ * @param items Pointer to `count` contiguous elements (must not point into `vec`).
+ * @param count Number of elements to copy.
+ * @return 0 on success, or -1 on failure (the vector is left unchanged).
+*/
+int vvec_insert_range(vvec_t* vec, ssize_t index, const void* items, size_t count);
+
+/**
+ * @brief Replaces the contents of the vector with copies of `count` elements.
+ *
+ * @param vec Pointer to the vvec.
+ * @param items Pointer to `count` contiguous elements (must not point into `vec`).
+ * @param count Number of elements to copy.
+ * @return 0 on success, or -1 on failure (the vector is left empty).
+*/
+int vvec_assign(vvec_t* vec, const void* items, size_t count);
+
 /**
  * @brief Returns a pointer to the element at the specified index in the vvec.
  *
@@ -264,6 +465,24 @@ void vvec_pop_at(vvec_t* vec, ssize_t index);
 */
 void vvec_erase(vvec_t* vec, ssize_t first, ssize_t last);
 
+/**
+ * @brief Removes the item at `index` by moving the last item into its place (O(1), does not keep order).
+ *
+ * @param vec Pointer to the vvec.
+ * @param index index value. Can be negative of positive
+*/
+void vvec_swap_remove(vvec_t* vec, ssize_t index);
+
+/**
+ * @brief Removes every item `pred` returns non-zero for, in one pass. The remaining items keep their order.
+ *
+ * @param vec Pointer to the vvec.
+ * @param pred Predicate called once per item.
+ * @param ctx User context passed to `pred`.
+ * @return Number of items removed.
+*/
+size_t vvec_remove_if(vvec_t* vec, vvec_pred_fn pred, void* ctx);
+
 /**
  * @brief Erases all elements from the container.
  *
@@ -274,6 +493,7 @@ void vvec_clear(vvec_t* vec);
 /**
  * @brief Exchanges the contents and capacity of the container with those of `rhs`.
  * Does not invoke any move, copy, or swap operations on individual elements.
+ * Vectors with different allocators are left unchanged.
  * @param lhs Pointer ONE vvec.
  * @param rhs Pointer ANOTHER vvec.
 */
@@ -292,21 +512,222 @@ void vvec_shrink_to_fit(vvec_t* vec);
 */
 void vvec_destroy(vvec_t** vec);
 
+/**
+ * @brief Returns the index of the first element whose bytes equal `key`.
+ * Strides of 1, 2, 4, 8 and 16 bytes are scanned with SSE2/AVX2 on x86.
+ *
+ * @param vec Pointer to the vvec.
+ * @param key Pointer to `stride` bytes to look for.
+ * @return Index of the first match, or -1 if there is none.
+*/
+ssize_t vvec_find(vvec_t* vec, const void* key);
+
+/**
+ * @brief Returns the number of elements whose bytes equal `key`.
+ *
+ * @param vec Pointer to the vvec.
+ * @param key Pointer to `stride` bytes to look for.
+*/
+size_t vvec_count(vvec_t* vec, const void* key);
+
+/**
+ * @brief Sets every element of the vvec to `value`.
+ * Trivial elements are stored directly, others are destroyed and copy constructed.
+ *
+ * @param vec Pointer to the vvec.
+ * @param value Pointer to the element to copy (may point into `vec`).
+ * @return 0 on success, or -1 on failure. If a copy constructor fails part way,
+ * the elements from that one on are destroyed and the vvec keeps the ones before it.
+*/
+int vvec_fill(vvec_t* vec, const void* value);
+
+/**
+ * @brief Compares two vvecs element by element.
+ *
+ * @param lhs Pointer to ONE vvec.
+ * @param rhs Pointer to ANOTHER vvec.
+ * @return 1 if both have the same stride, length and bytes, else 0.
+*/
+int vvec_equal(vvec_t* lhs, vvec_t* rhs);
+
+/**
+ * @brief Sorts the vvec with `cmp` (introsort, not stable).
+ * Elements are moved bytewise, strides of 4, 8 and 16 bytes are swapped in registers.
+ *
+ * @param vec Pointer to the vvec.
+ * @param cmp Comparison function.
+ * @return 0 on success, or -1 on failure.
+*/
+int vvec_sort(vvec_t* vec, vvec_cmp_fn cmp);
+
+/**
+ * @brief Sorts the vvec in ascending order of a numeric key stored in each element (LSD radix sort, stable).
+ * Faster than vvec_sort for large vectors, at the cost of one temporary copy of the elements.
+ *
+ * @param vec Pointer to the vvec.
+ * @param key Type of the key.
+ * @param key_offset Offset of the key inside each element, in bytes.
+ * @return 0 on success, or -1 on failure.
+*/
+int vvec_sort_by_key(vvec_t* vec, VVEC_KEY key, size_t key_offset);
+
+/**
+ * @brief Returns the index of the first element that does not go before `key`.
+ * The vvec must be sorted by `cmp`.
+ *
+ * @param vec Pointer to the vvec.
+ * @param key Pointer to the value to look for, passed to `cmp` as its second argument.
+ * @param cmp Comparison function.
+ * @return Index in [0, length].
+*/
+size_t vvec_lower_bound(vvec_t* vec, const void* key, vvec_cmp_fn cmp);
+
+/**
+ * @brief Looks for an element equal to `key` in a vvec sorted by `cmp`.
+ *
+ * @param vec Pointer to the vvec.
+ * @param key Pointer to the value to look for, passed to `cmp` as its second argument.
+ * @param cmp Comparison function.
+ * @return Index of the first equal element, or -1 if there is none.
+*/
+ssize_t vvec_binary_search(vvec_t* vec, const void* key, vvec_cmp_fn cmp);
+
+/**
+ * @brief Takes a view of the vector's current storage.
+ *
+ * @param vec Pointer to the vvec.
+ * @return View of the elements, empty if `vec` is NULL.
+*/
+vvec_view_t vvec_view(vvec_t* vec);
+
+/**
+ * @brief Returns a pointer to the element at `index` of a view, without leaving the caller.
+ *
+ * @param view View of a vvec.
+ * @param index Index of the element, must be below the view's size.
+*/
+static inline void* vvec_view_at(vvec_view_t view, size_t index)
+    {return view.data + (index * view.stride);}
+
+/**
+ * @brief Returns the number of elements in a view.
+*/
+static inline size_t vvec_view_size(vvec_view_t view)
+    {return view.size;}
+
+/**
+ * @brief Returns a pointer to the first element of a view.
+*/
+static inline void* vvec_view_data(vvec_view_t view)
+    {return view.data;}
+
+/**
+ * @brief Returns the elements of a view as a `T` array, so loops index with a constant stride.
+*/
+#define vvec_view_as(T, view) ((T*)vvec_view_data(view))
+
 /**
  * Macro to iterate over a vvec
  * @param T Type of the item to iterate over
  * @param item A variable of type T that will be assigned each element of the vector
  * @param vec The vvec to iterate over
  * @param action The action to perform on each iteration(if any) -> Optional
+ * @note The vector is read once through vvec_view, so `action` must not grow or shrink it.
 */
 #define vvec_foreach(T, item, index, vec, action) do { \
-    size_t __len = vvec_get_field(vec, VVEC_FIELD_LENGTH); \
-    for (size_t index = 0; index < __len; index++) { \
-        T* item = (T*)vvec_at(vec, index); \
+    vvec_view_t __view = vvec_view(vec); \
+    for (size_t index = 0; index < __view.size; index++) { \
+        T* item = (T*)vvec_view_at(__view, index); \
         action \
     }\
 } while(0)
 
+/**
+ * @brief Returns the capacity a buffer grows to under the vvec growth policy.
+ *
+ * @param capacity Current capacity.
+ * @param min_capacity Capacity that is needed at least.
+ * @param stride Size of each element.
+ * @param scale Scale factor (0.5 = grow by half).
+ * @param page Buffers larger than this many bytes are rounded up to whole steps of it (0 = off).
+ * @return New capacity.
+*/
+size_t _vvec_next_capacity(size_t capacity, size_t min_capacity, size_t stride, double scale, size_t page);
+
+/**
+ * @brief Defines a typed vector `name` of trivially copyable `T` elements.
+ *
+ * Everything is static inline and indexes with `sizeof(T)` known at compile time,
+ * so loops over `name.data` can be unrolled and vectorized. Only growing calls into vvec.c.
+ * A zero initialized `name` is an empty vector that allocates from vallocator_default();
+ * `name_init_alloc` picks another allocator. Release it with `name_free`.
+ *
+ * Generates: name_init, name_init_alloc, name_free, name_size, name_capacity, name_data, name_at,
+ * name_reserve, name_resize, name_push, name_append_n, name_pop, name_clear.
+ *
+ * @param name Name of the generated type and prefix of its functions.
+ * @param T Element type, copied with plain assignment / memcpy.
+*/
+#define VVEC_DEFINE(name, T) \
+    typedef struct name { \
+        T* data;            /* Elements */ \
+        size_t size;        /* Number of elements */ \
+        size_t capacity;    /* Allocated elements */ \
+        const vallocator_t* allocator; /* Source of `data`, NULL until the first allocation for the default */ \
+    } name; \
+    static inline void name##_init(name* vec) \
+        {vec->data = NULL; vec->size = 0; vec->capacity = 0; vec->allocator = NULL;} \
+    static inline void name##_init_alloc(name* vec, const vallocator_t* allocator) \
+        {name##_init(vec); vec->allocator = allocator;} \
+    static inline void name##_free(name* vec) { \
+        const vallocator_t* allocator = vec->allocator; \
+        _vstd_release(allocator, VSTD_MEM_VVEC, vec->data, vec->capacity * sizeof(T), 0); \
+        name##_init_alloc(vec, allocator); \
+    } \
+    static inline size_t name##_size(const name* vec) \
+        {return vec->size;} \
+    static inline size_t name##_capacity(const name* vec) \
+        {return vec->capacity;} \
+    static inline T* name##_data(name* vec) \
+        {return vec->data;} \
+    static inline T* name##_at(name* vec, size_t index) \
+        {assert(index < vec->size && "index out-of-range"); return &vec->data[index];} \
+    static inline int name##_realloc(name* vec, size_t capacity) { \
+        if (!vec->allocator) vec->allocator = _vstd_allocator(NULL); \
+        T* data = (T*)((vec->data)? \
+            _vstd_resize(vec->allocator, VSTD_MEM_VVEC, vec->data, vec->capacity * sizeof(T), capacity * sizeof(T), 0) : \
+            _vstd_alloc(vec->allocator, VSTD_MEM_VVEC, capacity * sizeof(T), 0)); \
+        if (!data) return -1; \
+        vec->data = data; \
+        vec->capacity = capacity; \
+        return 0; \
+    } \
+    static inline int name##_grow(name* vec, size_t min_capacity) \
+        {return name##_realloc(vec, _vvec_next_capacity(vec->capacity, min_capacity, sizeof(T), 0.5, VVEC_GROWTH_PAGE));} \
+    static inline int name##_reserve(name* vec, size_t reserves) \
+        {return (reserves)? name##_realloc(vec, vec->capacity + reserves) : 0;} \
+    static inline int name##_resize(name* vec, size_t new_size) { \
+        if (new_size > vec->capacity && name##_grow(vec, new_size) == -1) return -1; \
+        if (new_size > vec->size) memset(vec->data + vec->size, 0, (new_size - vec->size) * sizeof(T)); \
+        vec->size = new_size; \
+        return 0; \
+    } \
+    static inline int name##_push(name* vec, T value) { \
+        if (vec->size == vec->capacity && name##_grow(vec, vec->size + 1) == -1) return -1; \
+        vec->data[vec->size++] = value; \
+        return 0; \
+    } \
+    static inline int name##_append_n(name* vec, const T* items, size_t count) { \
+        if (vec->size + count > vec->capacity && name##_grow(vec, vec->size + count) == -1) return -1; \
+        if (count) memcpy(vec->data + vec->size, items, count * sizeof(T)); \
+        vec->size += count; \
+        return 0; \
+    } \
+    static inline void name##_pop(name* vec) \
+        {assert(vec->size && "index out-of-range"); vec->size--;} \
+    static inline void name##_clear(name* vec) \
+        {vec->size = 0;}
+
 #ifdef __cplusplus
 }
 #endif